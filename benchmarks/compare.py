@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+# Compare the run time and memory of solver commands on the same instances.
+#
+# usage: compare.py [-r RUNS] [-t TIMEOUT] [-m] -c COMMAND -c COMMAND ... INSTANCE...
+#
+# Each command (for example "build/release/maxino -strat=2") is run RUNS times on each instance, alternating the
+# commands, and the median wall-clock time is printed. With -m, the largest peak RSS is printed instead.
+# A run killed by the timeout is printed as >TIMEOUT. The last column tells whether all commands printed the same output.
+import argparse, hashlib, os, shlex, signal, statistics, subprocess, threading, time
+
+def run(command, instance, timeout):
+    start = time.time()
+    p = subprocess.Popen(shlex.split(command) + [instance], stdout=subprocess.PIPE, stderr=subprocess.DEVNULL)
+    timer = threading.Timer(timeout, p.kill)
+    timer.start()
+    out = p.stdout.read()
+    _, status, usage = os.wait4(p.pid, 0)
+    timer.cancel()
+    elapsed = time.time() - start
+    if os.WIFSIGNALED(status) and os.WTERMSIG(status) == signal.SIGKILL: out = None
+    return elapsed, out, usage.ru_maxrss
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("-r", "--runs", type=int, default=3)
+    parser.add_argument("-t", "--timeout", type=float, default=300)
+    parser.add_argument("-m", "--memory", action="store_true")
+    parser.add_argument("-c", "--command", action="append", required=True)
+    parser.add_argument("instances", nargs="+")
+    args = parser.parse_args()
+
+    print("%-20s %s" % ("instance", " ".join("%9s" % ("#%d" % (i + 1)) for i in range(len(args.command)))))
+    totals = [0.0] * len(args.command)
+    for instance in args.instances:
+        values = [[] for _ in args.command]
+        outputs = [set() for _ in args.command]
+        for _ in range(args.runs):
+            for i, command in enumerate(args.command):
+                elapsed, out, rss = run(command, instance, args.timeout)
+                values[i].append(rss if args.memory else (elapsed if out is not None else None))
+                outputs[i].add(hashlib.md5(out).hexdigest() if out is not None else None)
+        row = []
+        for i in range(len(args.command)):
+            if args.memory: v = max(values[i]); row.append("%9d KB" % v)
+            elif None in values[i]: row.append("%9s" % (">%gs" % args.timeout)); totals[i] = None
+            else:
+                v = statistics.median(values[i]); row.append("%8.2fs" % v)
+                if totals[i] is not None: totals[i] += v
+        same = len(set.union(*outputs)) == 1 and None not in outputs[0]
+        print("%-20s %s  %s" % (os.path.basename(instance), " ".join(row), "same output" if same else "different output"))
+    if not args.memory:
+        print("%-20s %s" % ("total", " ".join("%8.2fs" % t if t is not None else "%9s" % "-" for t in totals)))
+
+if __name__ == "__main__":
+    main()
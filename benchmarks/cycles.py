@@ -0,0 +1,39 @@
+#!/usr/bin/env python3
+# ASP programs (aspino input format) made of K head-cycle components. Each component is a disjunction of M atoms
+# in a positive cycle, as in a|b|c. b :- a. c :- b. a :- c.
+#
+# usage: cycles.py K M OUTPUT
+import sys
+
+def generate(k, m, path):
+    rules = []; group = []
+    for g in range(k):
+        at = [g * m + i + 1 for i in range(m)]
+        rules.append((at, [], [])); group.append(g)
+        for i in range(m): rules.append(([at[(i + 1) % m]], [at[i]], [])); group.append(g)
+    n = k * m
+    out = ["p asp"]; nv = n; bodies = {}
+    for i, (hs, pos, neg) in enumerate(rules):
+        nv += 1; b = nv; lits = pos + [-q for q in neg]
+        for l in lits: out.append("%d %d 0" % (-b, l))
+        out.append(" ".join([str(b)] + [str(-l) for l in lits] + ["0"]))
+        out.append(" ".join([str(-b)] + [str(h) for h in hs] + ["0"]))
+        bodies[i] = b
+    sup = {a: [] for a in range(1, n + 1)}
+    for i, (hs, pos, neg) in enumerate(rules):
+        for a in hs:
+            if len(hs) == 1: sup[a].append(bodies[i]); continue
+            nv += 1; sb = nv; lits = [bodies[i]] + [-h for h in hs if h != a]
+            for l in lits: out.append("%d %d 0" % (-sb, l))
+            out.append(" ".join([str(sb)] + [str(-l) for l in lits] + ["0"]))
+            sup[a].append(sb)
+    for a in range(1, n + 1): out.append(" ".join([str(-a)] + [str(b) for b in sup[a]] + ["0"]))
+    for (hs, pos, neg), g in zip(rules, group):
+        out.append("h %d %s 0 0 %s 0" % (g, " ".join(map(str, hs)), " ".join(map(str, pos))))
+    for a in range(1, n + 1): out.append("v %d a%d" % (a, a))
+    out.append("n %d" % nv)
+    open(path, "w").write("\n".join(out) + "\n")
+
+if __name__ == "__main__":
+    if len(sys.argv) != 4: sys.exit("usage: %s K M OUTPUT" % sys.argv[0])
+    generate(int(sys.argv[1]), int(sys.argv[2]), sys.argv[3])
@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+# ASP programs (aspino input format) whose inferences come from source pointers and weight constraints.
+# There are K positive loops of L atoms, and EXT atoms of each loop have an external support chosen by an even loop.
+# NWC weight constraints force one of three loop atoms to be true, NWC/5 of them force one of two external supports,
+# and weak constraints prefer to drop external supports.
+#
+# usage: loops.py SEED K L EXT NWC OUTPUT
+import random, sys
+
+def write(n, rules, wcs, weak, f):
+    out = ["p asp"]
+    nv = n
+    bodies = {}
+    for i, (hs, pos, neg) in enumerate(rules):
+        nv += 1; b = nv
+        lits = pos + [-q for q in neg]
+        for l in lits: out.append("%d %d 0" % (-b, l))
+        out.append(" ".join([str(b)] + [str(-l) for l in lits] + ["0"]))
+        out.append(" ".join([str(-b)] + [str(h) for h in hs] + ["0"]))
+        bodies[i] = b
+    for a in range(1, n + 1):
+        sup = [(bodies[i], pos) for i, (hs, pos, neg) in enumerate(rules) if a in hs]
+        out.append(" ".join([str(-a)] + [str(b) for b, _ in sup] + ["0"]))
+        for b, pos in sup: out.append("s %d %d %s0" % (a, b, "".join("%d " % p for p in pos)))
+    for ls, ws, b in wcs:
+        out.append("a %s 0 %s %d" % (" ".join(map(str, ls)), " ".join(map(str, ws)), b))
+    for l, w in weak: out.append("w %d %d 0" % (l, w))
+    for a in range(1, n + 1): out.append("v %d a%d" % (a, a))
+    out.append("n %d" % nv)
+    f.write("\n".join(out) + "\n")
+
+def generate(seed, k, L, ext, nwc, path):
+    r = random.Random(seed)
+    rules = []; n = 0; loops = []; xs = []
+    for _ in range(k):
+        at = [n + i + 1 for i in range(L)]; n += L; loops.append(at)
+        for i in range(L): rules.append(([at[(i + 1) % L]], [at[i]], []))
+        for a in r.sample(at, ext):
+            n += 2; x = n - 1; z = n; xs.append(z)
+            rules.append(([a], [x], [])); rules.append(([x], [], [z])); rules.append(([z], [], [x]))
+    wcs = []
+    loopAtoms = [a for at in loops for a in at]
+    for _ in range(nwc): wcs.append((r.sample(loopAtoms, 3), [1] * 3, 1))
+    for _ in range(nwc // 5): wcs.append((r.sample(xs, 2), [1] * 2, 1))
+    weak = [(x, r.randint(1, 3)) for x in xs]
+    write(n, rules, wcs, weak, open(path, "w"))
+
+if __name__ == "__main__":
+    if len(sys.argv) != 7: sys.exit("usage: %s SEED K L EXT NWC OUTPUT" % sys.argv[0])
+    generate(*[int(x) for x in sys.argv[1:6]], path=sys.argv[6])
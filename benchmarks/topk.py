@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+# Time the top-k mode of maxino against k independent runs, each one blocking the solutions printed before.
+#
+# usage: topk.py [-t TIMEOUT] MAXINO K INSTANCE...
+#
+# Soft clauses are first replaced by soft unit clauses r, with hard clauses r -> clause, so that the solutions blocked by
+# -top-k are exactly the assignments of the soft literals blocked by the independent runs. Both columns print the time and
+# the number of solutions; the last column tells whether the two sequences of costs are equal.
+import argparse, os, shlex, subprocess, tempfile, time
+
+def load(path):
+    hard = []; soft = []; n = 0; top = None
+    for line in open(path):
+        t = line.split()
+        if not t or t[0] == "c": continue
+        if t[0] == "p": n = int(t[2]); top = int(t[4]); continue
+        w = int(t[0]); lits = [int(x) for x in t[1:-1]]
+        (hard if w == top else soft).append((w, lits))
+    return n, top, hard, soft
+
+def write(path, n, top, hard, soft, blocking):
+    clauses = ["%d %s 0" % (top, " ".join(map(str, c))) for _, c in hard]
+    for j, (w, c) in enumerate(soft):
+        clauses.append("%d %d %s 0" % (top, -(n + j + 1), " ".join(map(str, c))))
+        clauses.append("%d %d 0" % (w, n + j + 1))
+    clauses += ["%d %s 0" % (top, " ".join(map(str, c))) for c in blocking]
+    open(path, "w").write("p wcnf %d %d %d\n" % (n + len(soft), len(clauses), top) + "\n".join(clauses) + "\n")
+
+def run(command, timeout):
+    start = time.time()
+    try: out = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, universal_newlines=True, timeout=timeout).stdout
+    except subprocess.TimeoutExpired: return None, []
+    models = []
+    for line in out.split("\n"):
+        if line.startswith("v ") and len(line.split()) > 1: models.append({int(x) for x in line.split()[1:]})
+    return time.time() - start, models
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("-t", "--timeout", type=float, default=300)
+    parser.add_argument("maxino")
+    parser.add_argument("k", type=int)
+    parser.add_argument("instances", nargs="+")
+    args = parser.parse_args()
+
+    print("%-20s %18s %18s" % ("instance", "top-k", "independent runs"))
+    for instance in args.instances:
+        n, top, hard, soft = load(instance)
+        relaxed = [n + j + 1 for j in range(len(soft))]
+        cost = lambda m: sum(w for (w, _), r in zip(soft, relaxed) if r not in m)
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "instance.wcnf")
+            write(path, n, top, hard, soft, [])
+            topkTime, models = run(shlex.split(args.maxino) + ["-top-k", "-n=%d" % args.k, path], args.timeout)
+            topkCosts = [cost(m) for m in models]
+
+            runsTime = 0; blocking = []; runsCosts = []
+            while len(runsCosts) < args.k:
+                write(path, n, top, hard, soft, blocking)
+                elapsed, models = run(shlex.split(args.maxino) + [path], args.timeout)
+                if elapsed is None: runsTime = None; break
+                runsTime += elapsed
+                if not models: break
+                runsCosts.append(cost(models[-1]))
+                blocking.append([-r if r in models[-1] else r for r in relaxed])
+        column = lambda t, c: ("%8.2fs" % t if t is not None else "%9s" % "timeout") + " %3d sols" % len(c)
+        print("%-20s %18s %18s  %s" % (os.path.basename(instance), column(topkTime, topkCosts), column(runsTime, runsCosts),
+                                      "same costs" if topkCosts == runsCosts else "different costs"))
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,23 @@
+#!/usr/bin/env python3
+# Random weighted MaxSAT instances: hard 3-clauses, and soft clauses of 1-3 literals with weights in 1..W.
+#
+# usage: wcnf.py SEED VARIABLES HARD SOFT W OUTPUT
+import random, sys
+
+def generate(seed, n, h, s, W, path):
+    r = random.Random(seed)
+    top = 10**9
+    lines = ["p wcnf %d %d %d" % (n, h + s, top)]
+    for _ in range(h):
+        vs = r.sample(range(1, n + 1), 3)
+        lines.append("%d %s 0" % (top, " ".join(str(v if r.random() < .5 else -v) for v in vs)))
+    for _ in range(s):
+        k = r.choice([1, 1, 2, 3])
+        vs = r.sample(range(1, n + 1), k)
+        w = r.randint(1, W) if W > 1 else 1
+        lines.append("%d %s 0" % (w, " ".join(str(v if r.random() < .5 else -v) for v in vs)))
+    open(path, "w").write("\n".join(lines) + "\n")
+
+if __name__ == "__main__":
+    if len(sys.argv) != 7: sys.exit("usage: %s SEED VARIABLES HARD SOFT W OUTPUT" % sys.argv[0])
+    generate(*[int(x) for x in sys.argv[1:6]], path=sys.argv[6])
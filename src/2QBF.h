@@ -19,14 +19,14 @@
 #define zuccherino_2qbf_h
 
 #include "Data.h"
-#include "GlucoseWrapper.h"
+#include "StaticSolver.h"
 #include "CardinalityConstraint.h"
 
 namespace zuccherino {
 
-class QBF : public GlucoseWrapper {
+class QBF : public StaticGlucoseWrapper<CardinalityConstraintPropagator> {
 public:
-    inline QBF() : GlucoseWrapper(), ccPropagator(*this) {}
+    inline QBF() : ccPropagator(*this) { setPropagators(ccPropagator); }
     
     virtual Var newVar(bool polarity = true, bool dvar = true);
     
@@ -48,7 +48,7 @@ private:
     
     vec<Lit> softLits;
     
-    class Checker : public GlucoseWrapper {
+    class Checker : public EmbeddedSolver {
         friend QBF;
     };
     Checker inner;
@@ -21,6 +21,8 @@
 
 extern Glucose::IntOption option_n;
 extern Glucose::BoolOption option_print_model;
+extern Glucose::BoolOption option_restore_on_cancel;
+extern Glucose::IntOption option_hcc_threads;
 
 static Glucose::BoolOption option_asp_dlv_output("ASP", "asp-dlv-output", "Set output format in DLV style.", false);
 
@@ -110,7 +112,7 @@ void ASP::HCCParser::parseDetach() {
 }
 
 
-ASP::ASP() : weakParser(*this), weightConstraintParser(*this), spParser(*this), hccParser(*this), endParser(*this), ccPropagator(*this), wcPropagator(*this, &ccPropagator), spPropagator(NULL), optimization(false) {
+ASP::ASP() : weakParser(*this), weightConstraintParser(*this), spParser(*this), hccParser(*this), endParser(*this), ccPropagator(*this, false, option_restore_on_cancel), wcPropagator(*this, &ccPropagator, option_restore_on_cancel), spPropagator(NULL), hccScheduler(NULL), optimization(false) {
     setProlog("asp");
     setParser('w', &weakParser);
     setParser('a', &weightConstraintParser);
@@ -147,6 +149,7 @@ ASP::ASP() : weakParser(*this), weightConstraintParser(*this), spParser(*this),
 ASP::~ASP() {
     if(spPropagator != NULL) delete spPropagator;
     for(int i = 0; i < hccs.size(); i++) delete hccs[i];
+    delete hccScheduler;
 }
 
 bool ASP::interrupt() {
@@ -210,6 +213,10 @@ void ASP::endProgram(int numberOfVariables) {
     }
     for(int i = 0; i < softLits.size(); i++) setFrozen(var(softLits[i]), true);
 
+    if(option_hcc_threads > 1 && hccs.size() > 1) {
+        hccScheduler = new HCCScheduler(option_hcc_threads);
+        for(int i = 0; i < hccs.size(); i++) hccScheduler->add(hccs[i]);
+    }
     if(!activatePropagators()) return;
     if(!simplify()) return;
 }
@@ -299,6 +306,9 @@ lbool ASP::solve() {
 
     lbool status = solveInternal();
 
+    statistics(for(int i = 0; i < hccs.size(); i++) print_statistics(hcc, "component " << i << ": " << hccs[i]->getChecks() << " checks (" << hccs[i]->getPartialChecks() << " partial, " << hccs[i]->getUsefulPartialChecks() << " inferring); " << hccs[i]->getCheckPropagations() << " propagations; " << hccs[i]->getKeptAssumptions() << " assumptions kept from the previous check"));
+    statistics(if(hccScheduler != NULL) print_statistics(hcc, "parallel checks: " << hccScheduler->getParallelChecks()));
+    statistics(if(spPropagator != NULL) print_statistics(sp, "unfounded sets explained: " << spPropagator->getExplainedSets() << "; explanations reused: " << spPropagator->getReusedExplanations()));
     onDoneIteration();
 
     return status;
@@ -112,6 +112,8 @@ private:
     WeightConstraintPropagator wcPropagator;
     SourcePointers* spPropagator;
     vec<HCC*> hccs;
+    // NULL if checks of components are not run in parallel
+    HCCScheduler* hccScheduler;
     
     struct LitData : LitDataBase {
         int64_t weight;
@@ -19,7 +19,8 @@
 #define zuccherino_axioms_propagator_h
 
 #include "Data.h"
-#include "GlucoseWrapper.h"
+#include "EmbeddedSolver.h"
+#include "Occurrences.h"
 
 namespace zuccherino {
 
@@ -27,22 +28,27 @@ template<typename Axiom>
 struct VarDataAxiomsPropagator : VarDataBase {
     Axiom* reason;
 };
-struct LitDataAxiomsPropagator : LitDataBase {
-    vec<int> observed;
-};
+struct LitDataAxiomsPropagator : LitDataBase {};
+
+// How axioms are brought back to a consistent state by onCancel:
+// CANCEL_RESET only moves the trail cursor back (for axioms that need no undo),
+// CANCEL_NOTIFY calls P::onUnassign for each observed axiom of each unassigned literal,
+// CANCEL_RESTORE copies back the loosable of the axioms modified at the undone decision levels.
+enum CancelPolicy { CANCEL_RESET, CANCEL_NOTIFY, CANCEL_RESTORE };
 
 template<typename Axiom, typename P>
 class AxiomsPropagator : public Propagator {
 public:
-    AxiomsPropagator(GlucoseWrapper& solver, bool notifyOnCancel = false);
-    AxiomsPropagator(GlucoseWrapper& solver, const AxiomsPropagator& init);
+    AxiomsPropagator(EmbeddedSolver& solver, CancelPolicy cancelPolicy = CANCEL_RESET);
+    AxiomsPropagator(EmbeddedSolver& solver, const AxiomsPropagator& init);
     virtual ~AxiomsPropagator();
     
-    virtual bool activate() { return true; }
+    virtual bool activate() { observers.build(); return true; }
     
     virtual void onCancel();
     virtual bool simplify();
     virtual bool propagate();
+    virtual bool onWatched(Lit lit);
     
     virtual void getConflict(vec<Lit>& ret);
     virtual void getReason(Lit lit, vec<Lit>& ret);
@@ -50,7 +56,9 @@ public:
 protected:
     Data<typename Axiom::VarData, typename Axiom::LitData> data;
     
-    inline Axiom& observed(Lit lit, int index) { return *axioms[observed(lit)[index]]; }
+    inline Axiom& observed(Lit lit, int index) { return *axioms[observers(toInt(lit), index)]; }
+    inline Axiom& axiom(int index) { return *axioms[index]; }
+    inline int nAxioms() const { return axioms.size(); }
 
     void add(Axiom* axiom);
     void uncheckedEnqueue(Lit lit, Axiom& axiom);
@@ -62,24 +70,42 @@ private:
         int lit;
         int axiom;
     } next;
-    bool notifyOnCancel;
+    CancelPolicy cancelPolicy;
     vec<Axiom*> axioms;
+    // indices of the axioms observing each literal (key toInt(lit)); built at activation, and again after new axioms are added
+    Occurrences<int> observers;
     vec<Lit> conflictClause;
     
+    // used by CANCEL_RESTORE: loosable of axioms before their first change at each decision level
+    struct Backup {
+        inline Backup() {}
+        inline Backup(int axiom_, decltype(Axiom::loosable) loosable_) : axiom(axiom_), loosable(loosable_) {}
+        int axiom;
+        decltype(Axiom::loosable) loosable;
+    };
+    vec<Backup> backups;
+    vec<int> backupsLim;
+    vec<int> backupIndex;
+    
     inline Axiom*& reason(Var v) { return data(v).reason; }
-    inline vec<int>& observed(Lit lit){ return data(lit).observed; }
+    inline int nObserved(Lit lit) const { return observers.size(toInt(lit)); }
+    
+    void backup(int index);
+    void restore();
 };
 
 template<typename Axiom, typename P>
-AxiomsPropagator<Axiom, P>::AxiomsPropagator(GlucoseWrapper& solver, bool notifyOnCancel_) : Propagator(solver), notifyOnCancel(notifyOnCancel_) {}
+AxiomsPropagator<Axiom, P>::AxiomsPropagator(EmbeddedSolver& solver, CancelPolicy cancelPolicy_) : Propagator(solver), cancelPolicy(cancelPolicy_) {}
 
 template<typename Axiom, typename P>
-AxiomsPropagator<Axiom, P>::AxiomsPropagator(GlucoseWrapper& solver, const AxiomsPropagator& init) : Propagator(solver, init), data(init.data), notifyOnCancel(init.notifyOnCancel) {
+AxiomsPropagator<Axiom, P>::AxiomsPropagator(EmbeddedSolver& solver, const AxiomsPropagator& init) : Propagator(solver, init), data(init.data), next(init.next), cancelPolicy(init.cancelPolicy), observers(init.observers) {
     assert(solver.decisionLevel() == 0);
     for(int i = 0; i < init.axioms.size(); i++) {
         axioms.push(new Axiom(*init.axioms[i]));
+        backupIndex.push(-1);
     }
     init.conflictClause.copyTo(conflictClause);
+    if(inlineWatches) for(int i = 0; i < data.lits(); i++) watch(data.lit(i));
 }
 
 template<typename Axiom, typename P>
@@ -90,7 +116,9 @@ AxiomsPropagator<Axiom, P>::~AxiomsPropagator() {
 
 template<typename Axiom, typename P>
 void AxiomsPropagator<Axiom, P>::onCancel() {
-    if(!notifyOnCancel) { next.lit = solver.nAssigns(); next.axiom = 0; return; }
+    observers.build();
+    if(cancelPolicy == CANCEL_RESTORE) restore();
+    if(cancelPolicy != CANCEL_NOTIFY) { next.lit = solver.nAssigns(); next.axiom = 0; return; }
     
     if(next.axiom != 0) {
         assert_msg(next.lit >= solver.nAssigns(), "next.lit=" << next.lit << "; solver.nAssigns()=" << solver.nAssigns());
@@ -102,25 +130,23 @@ void AxiomsPropagator<Axiom, P>::onCancel() {
     
     while(next.lit > solver.nAssigns()) {
         Lit lit = solver.assigned(--next.lit);
-        if(!data.has(lit)) continue;
-        vec<int>& v = observed(lit);
-        for(next.axiom = v.size(); next.axiom > 0;) static_cast<P*>(this)->onUnassign(lit, --next.axiom);
+        for(next.axiom = nObserved(lit); next.axiom > 0;) static_cast<P*>(this)->onUnassign(lit, --next.axiom);
         assert(next.axiom == 0);
     }
 }
 
 template<typename Axiom, typename P>
 bool AxiomsPropagator<Axiom, P>::simplify() {
+    observers.build();
+    if(inlineWatches) return true;
     int n = solver.nAssigns();
     while(next.lit < n) {
         Lit lit = solver.assigned(next.lit);
-        if(data.has(lit)) {
-            vec<int>& v = observed(lit);
-            assert(next.axiom <= v.size());
-            while(next.axiom < v.size()) {
-                if(!static_cast<P*>(this)->onSimplify(lit, next.axiom++)) return false;
-                if(solver.nAssigns() > n) return true;
-            }
+        int size = nObserved(lit);
+        assert(next.axiom <= size);
+        while(next.axiom < size) {
+            if(!static_cast<P*>(this)->onSimplify(lit, next.axiom++)) return false;
+            if(solver.nAssigns() > n) return true;
         }
         next.lit++;
         next.axiom = 0;
@@ -131,16 +157,17 @@ bool AxiomsPropagator<Axiom, P>::simplify() {
 
 template<typename Axiom, typename P>
 bool AxiomsPropagator<Axiom, P>::propagate() {
+    observers.build();
+    if(inlineWatches) return true;
     int n = solver.nAssigns();
     while(next.lit < n) {
         Lit lit = solver.assigned(next.lit);
-        if(data.has(lit)) {
-            vec<int>& v = observed(lit);
-            assert(next.axiom <= v.size());
-            while(next.axiom < v.size()) {
-                if(!static_cast<P*>(this)->onAssign(lit, next.axiom++)) return false;
-                if(solver.nAssigns() > n) return true;
-            }
+        int size = nObserved(lit);
+        assert(next.axiom <= size);
+        while(next.axiom < size) {
+            if(cancelPolicy == CANCEL_RESTORE) backup(observers(toInt(lit), next.axiom));
+            if(!static_cast<P*>(this)->onAssign(lit, next.axiom++)) return false;
+            if(solver.nAssigns() > n) return true;
         }
         next.lit++;
         next.axiom = 0;
@@ -149,10 +176,35 @@ bool AxiomsPropagator<Axiom, P>::propagate() {
     return true;
 }
 
+template<typename Axiom, typename P>
+bool AxiomsPropagator<Axiom, P>::onWatched(Lit lit) {
+    // literals are watched in trail order, so the cursor is still meaningful for onCancel
+    assert(solver.assignedIndex(lit) >= next.lit);
+    next.lit = solver.assignedIndex(lit);
+    next.axiom = 0;
+    
+    observers.build();
+    int size = nObserved(lit);
+    if(solver.decisionLevel() == 0) {
+        while(next.axiom < size) if(!static_cast<P*>(this)->onSimplify(lit, next.axiom++)) return false;
+    }
+    else {
+        while(next.axiom < size) {
+            if(cancelPolicy == CANCEL_RESTORE) backup(observers(toInt(lit), next.axiom));
+            if(!static_cast<P*>(this)->onAssign(lit, next.axiom++)) return false;
+        }
+    }
+    next.lit++;
+    next.axiom = 0;
+    return true;
+}
+
 template<typename Axiom, typename P>
 void AxiomsPropagator<Axiom, P>::getConflict(vec<Lit>& ret) {
     assert(conflictClause.size() > 0);
-    conflictClause.moveTo(ret);
+    // copy to keep the capacity of conflictClause
+    conflictClause.copyTo(ret);
+    conflictClause.clear();
 }
 
 template<typename Axiom, typename P>
@@ -164,12 +216,34 @@ void AxiomsPropagator<Axiom, P>::getReason(Lit lit, vec<Lit>& ret) {
 template<typename Axiom, typename P>
 void AxiomsPropagator<Axiom, P>::add(Axiom* axiom) {
     vec<Lit> lits;
+    int n = data.lits();
     static_cast<P*>(this)->notifyFor(*axiom, lits);
-    for(int i = 0; i < lits.size(); i++) {
-        Lit lit = lits[i];
-        observed(lit).push(axioms.size());
-    }
+    if(inlineWatches) for(int i = n; i < data.lits(); i++) watch(data.lit(i));
+    for(int i = 0; i < lits.size(); i++) observers.push(toInt(lits[i]), axioms.size());
     axioms.push(axiom);
+    backupIndex.push(-1);
+}
+
+template<typename Axiom, typename P>
+void AxiomsPropagator<Axiom, P>::backup(int index) {
+    int level = solver.decisionLevel();
+    if(level == 0) return;
+    while(backupsLim.size() < level) backupsLim.push(backups.size());
+    
+    int& i = backupIndex[index];
+    if(i >= backupsLim.last() && i < backups.size() && backups[i].axiom == index) return;
+    i = backups.size();
+    backups.push(Backup(index, axioms[index]->loosable));
+}
+
+template<typename Axiom, typename P>
+void AxiomsPropagator<Axiom, P>::restore() {
+    int level = solver.decisionLevel();
+    if(backupsLim.size() <= level) return;
+    
+    for(int i = backups.size() - 1; i >= backupsLim[level]; i--) axioms[backups[i].axiom]->loosable = backups[i].loosable;
+    backups.shrink_(backups.size() - backupsLim[level]);
+    backupsLim.shrink_(backupsLim.size() - level);
 }
 
 template<typename Axiom, typename P>
@@ -17,7 +17,7 @@
 
 #include "CardinalityConstraint.h"
 
-#include "GlucoseWrapper.h"
+#include "EmbeddedSolver.h"
 
 namespace zuccherino {
 
@@ -88,6 +88,84 @@ bool CardinalityConstraintPropagator::addEqual(vec<Lit>& lits, int bound) {
     return addGreaterEqual(lits, bound) && addLessEqual(tmp, bound);
 }
 
+void CardinalityConstraintPropagator::onCancel() {
+    if(!watched) { AxiomsPropagator::onCancel(); return; }
+    nextWatched = solver.nAssigns();
+}
+
+bool CardinalityConstraintPropagator::simplify() {
+    if(!watched) return AxiomsPropagator::simplify();
+    if(inlineWatches) return true;
+    return propagateWatched();
+}
+
+bool CardinalityConstraintPropagator::propagate() {
+    if(!watched) return AxiomsPropagator::propagate();
+    if(inlineWatches) return true;
+    return propagateWatched();
+}
+
+bool CardinalityConstraintPropagator::onWatched(Lit lit) {
+    if(!watched) return AxiomsPropagator::onWatched(lit);
+    return propagateWatched(lit);
+}
+
+bool CardinalityConstraintPropagator::propagateWatched() {
+    int n = solver.nAssigns();
+    while(nextWatched < n) {
+        Lit lit = solver.assigned(nextWatched++);
+        if(!data.has(lit)) continue;
+        if(!propagateWatched(lit)) return false;
+        if(solver.nAssigns() > n) return true;
+    }
+    assert(nextWatched == solver.nAssigns());
+    return true;
+}
+
+bool CardinalityConstraintPropagator::propagateWatched(Lit lit) {
+    vec<int>& ws = watches(lit);
+    int i, j;
+    for(i = j = 0; i < ws.size(); i++) {
+        CardinalityConstraint& cc = axiom(ws[i]);
+        trace(cc, 10, "Propagate " << lit << "@" << solver.decisionLevel() << " on " << cc);
+        
+        int n = watchSize(cc);
+        int k = 0;
+        while(cc.lits[k] != ~lit) k++;
+        assert(k < n);
+        
+        int r = n;
+        while(r < cc.lits.size() && solver.value(cc.lits[r]) == l_False) r++;
+        if(r < cc.lits.size()) {
+            Lit tmp = cc.lits[k];
+            cc.lits[k] = cc.lits[r];
+            cc.lits[r] = tmp;
+            watches(~cc.lits[k]).push(ws[i]);
+            continue;
+        }
+        
+        ws[j++] = ws[i];
+        for(int h = 0; h < n; h++) {
+            if(h == k) continue;
+            Lit l = cc.lits[h];
+            lbool v = solver.value(l);
+            if(v == l_Undef) {
+                trace(cc, 15, "Infer " << l);
+                uncheckedEnqueue(l, cc);
+            }
+            else if(v == l_False) {
+                trace(cc, 8, "Conflict on " << l << " while propagating " << lit << " on " << cc);
+                while(++i < ws.size()) ws[j++] = ws[i];
+                ws.shrink_(i - j);
+                setConflict(l, cc);
+                return false;
+            }
+        }
+    }
+    ws.shrink_(i - j);
+    return true;
+}
+
 void CardinalityConstraintPropagator::notifyFor(CardinalityConstraint& cc, vec<Lit>& lits) {
     assert(lits.size() == 0);
     
@@ -95,7 +173,9 @@ void CardinalityConstraintPropagator::notifyFor(CardinalityConstraint& cc, vec<L
         Lit lit = ~cc.lits[i];
         if(!data.has(var(lit))) data.push(solver, var(lit));
         if(!data.has(lit)) data.push(solver, lit);
-        lits.push(lit);
+        if(!watched) lits.push(lit);
+        // cc is going to be stored at index nAxioms()
+        else if(i < watchSize(cc)) watches(lit).push(nAxioms());
     }
 }
 
@@ -25,9 +25,12 @@ namespace zuccherino {
 struct CardinalityConstraint {
     friend ostream& operator<<(ostream& out, const CardinalityConstraint& cc) { return out << cc.toString(); }
     friend class CardinalityConstraintPropagator;
+    template<typename, typename> friend class AxiomsPropagator;
 public:
     struct VarData : VarDataAxiomsPropagator<CardinalityConstraint> {};
-    struct LitData : LitDataAxiomsPropagator {};
+    struct LitData : LitDataAxiomsPropagator {
+        vec<int> watches;
+    };
 
     CardinalityConstraint(const CardinalityConstraint& init);
 
@@ -43,8 +46,14 @@ private:
 class CardinalityConstraintPropagator: public AxiomsPropagator<CardinalityConstraint, CardinalityConstraintPropagator> {
     friend AxiomsPropagator;
 public:
-    inline CardinalityConstraintPropagator(GlucoseWrapper& solver) : AxiomsPropagator(solver, true) {}
-    inline CardinalityConstraintPropagator(GlucoseWrapper& solver, const CardinalityConstraintPropagator& init) : AxiomsPropagator(solver, init) {}
+    inline CardinalityConstraintPropagator(EmbeddedSolver& solver, bool watched_ = false, bool restoreOnCancel = false) : AxiomsPropagator(solver, watched_ ? CANCEL_RESET : restoreOnCancel ? CANCEL_RESTORE : CANCEL_NOTIFY), watched(watched_), nextWatched(0) {}
+    inline CardinalityConstraintPropagator(EmbeddedSolver& solver, const CardinalityConstraintPropagator& init) : AxiomsPropagator(solver, init), watched(init.watched), nextWatched(init.nextWatched) {}
+    
+    virtual void onCancel();
+    virtual bool simplify();
+    virtual bool propagate();
+    virtual bool onWatched(Lit lit);
+    using AxiomsPropagator::getReason;
     
     virtual bool addGreaterEqual(vec<Lit>& lits, int bound);
     bool addLessEqual(vec<Lit>& lits, int bound);
@@ -57,6 +66,15 @@ protected:
     static inline CardinalityConstraint* createCardinalityConstraint(vec<Lit>& lits, int bound) { return new CardinalityConstraint(lits, bound); }
     
 private:
+    // in watched mode, only the first bound+1 literals of each constraint are watched
+    bool watched;
+    int nextWatched;
+    
+    inline vec<int>& watches(Lit lit) { return data(lit).watches; }
+    static inline int watchSize(const CardinalityConstraint& cc) { return cc.lits.size() - cc.loosable + 1; }
+    bool propagateWatched();
+    bool propagateWatched(Lit lit);
+    
     void notifyFor(CardinalityConstraint& cc, vec<Lit>& lits);
     bool onSimplify(Lit lit, int observedIndex);
     bool onAssign(Lit lit, int observedIndex);
@@ -71,7 +89,7 @@ private:
 
 // stub for future tests
 class CardinalityConstraintPropagatorWithCompiler : public CardinalityConstraintPropagator {
-    inline CardinalityConstraintPropagatorWithCompiler(GlucoseWrapper& solver) : CardinalityConstraintPropagator(solver) {}
+    inline CardinalityConstraintPropagatorWithCompiler(EmbeddedSolver& solver) : CardinalityConstraintPropagator(solver) {}
 public:
     virtual bool activate();
     virtual bool addGreaterEqual(vec<Lit>& lits, int bound);
@@ -23,6 +23,7 @@ using std::make_pair;
 
 extern Glucose::IntOption option_n;
 extern Glucose::BoolOption option_print_model;
+extern Glucose::BoolOption option_restore_on_cancel;
 
 Glucose::IntOption option_circ_wit("CIRC", "circ-wit", "Number of desired witnesses. Non-positive integers are interpreted as unbounded.", 1, Glucose::IntRange(0, INT32_MAX));
 Glucose::BoolOption option_circ_propagate_and_exit("CIRC", "circ-propagate", "Just propagate and terminate.", false);
@@ -33,7 +34,7 @@ Glucose::IntOption option_circ_query_strat("CIRC", "circ-query-strat",
 
 namespace zuccherino {
 
-_Circumscription::_Circumscription() : ccPropagator(*this), wcPropagator(*this, &ccPropagator), spPropagator(NULL) {
+_Circumscription::_Circumscription() : ccPropagator(*this, false, option_restore_on_cancel), wcPropagator(*this, &ccPropagator, option_restore_on_cancel), spPropagator(NULL) {
 }
 
 _Circumscription::_Circumscription(const _Circumscription& init) : GlucoseWrapper(init), ccPropagator(*this, init.ccPropagator), wcPropagator(*this, init.wcPropagator, &ccPropagator), spPropagator(init.spPropagator != NULL ? new SourcePointers(*this, *init.spPropagator) : NULL) {
@@ -18,7 +18,7 @@
 #ifndef zuccherino_data_h
 #define zuccherino_data_h
 
-#include "GlucoseWrapper.h"
+#include "EmbeddedSolver.h"
 
 namespace zuccherino {
 
@@ -40,27 +40,28 @@ public:
     inline VarData& operator()(Var v) { return this->get(v); }
     inline const VarData& operator()(Var v) const { return this->get(v); }
     inline Var var(int idx) const { assert(idx < varData.size()); return varData[idx].var; }
-    void push(GlucoseWrapper& solver, Var v);
+    void push(EmbeddedSolver& solver, Var v);
 
     inline int lits() const { return litData.size(); }
-    inline bool has(Lit l) const { return Glucose::var(l) < litIndex[sign(l)].size() && litIndex[sign(l)][Glucose::var(l)] != UINT_MAX; }
-    inline int index(Lit l) const { assert(has(l)); return litIndex[sign(l)][Glucose::var(l)]; }
-    inline LitData& get(Lit l) { assert(has(l)); return litData[litIndex[sign(l)][Glucose::var(l)]]; }
-    inline const LitData& get(Lit l) const { assert(has(l)); return litData[litIndex[sign(l)][Glucose::var(l)]]; }
+    inline bool has(Lit l) const { return toInt(l) < litIndex.size() && litIndex[toInt(l)] != UINT_MAX; }
+    inline int index(Lit l) const { assert(has(l)); return litIndex[toInt(l)]; }
+    inline LitData& get(Lit l) { assert(has(l)); return litData[litIndex[toInt(l)]]; }
+    inline const LitData& get(Lit l) const { assert(has(l)); return litData[litIndex[toInt(l)]]; }
     inline LitData& operator()(Lit l) { return this->get(l); }
     inline const LitData& operator()(Lit l) const { return this->get(l); }
     inline Lit lit(int idx) const { assert(idx < litData.size()); return litData[idx].lit; }
-    void push(GlucoseWrapper& solver, Lit l);
+    void push(EmbeddedSolver& solver, Lit l);
 
 private:
     vec<unsigned> varIndex;
-    vec<unsigned> litIndex[2];
+    // indexed by toInt(lit), so that both literals of a variable are close
+    vec<unsigned> litIndex;
     vec<VarData> varData;
     vec<LitData> litData;
 };
 
 template<typename VarData, typename LitData>
-void Data<VarData, LitData>::push(GlucoseWrapper& solver, Var v) {
+void Data<VarData, LitData>::push(EmbeddedSolver& solver, Var v) {
     assert(!has(v));
     while(v >= varIndex.size()) varIndex.push(UINT_MAX);
     varIndex[v] = varData.size();
@@ -70,10 +71,10 @@ void Data<VarData, LitData>::push(GlucoseWrapper& solver, Var v) {
 }
 
 template<typename VarData, typename LitData>
-void Data<VarData, LitData>::push(GlucoseWrapper& solver, Lit l) {
+void Data<VarData, LitData>::push(EmbeddedSolver& solver, Lit l) {
     assert(!has(l));
-    while(Glucose::var(l) >= litIndex[sign(l)].size()) litIndex[sign(l)].push(UINT_MAX);
-    litIndex[sign(l)][Glucose::var(l)] = litData.size();
+    while(toInt(l) >= litIndex.size()) litIndex.push(UINT_MAX);
+    litIndex[toInt(l)] = litData.size();
     litData.push();
     litData.last().lit = l;
     solver.setFrozen(Glucose::var(l), true);
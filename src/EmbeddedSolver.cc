@@ -0,0 +1,290 @@
+/*
+ *  Copyright (C) 2017  Mario Alviano (mario@alviano.net)
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include "EmbeddedSolver.h"
+
+#include <utils/System.h>
+
+#include <chrono>
+
+extern Glucose::IntOption option_reason_cache;
+
+namespace zuccherino {
+
+#define trace_(level, msg) trace(solver, level, (id != "" ? "[" + id + "]": "") << msg)
+
+EmbeddedSolver::EmbeddedSolver() : nTrailPosition(0) {
+    setIncrementalMode();
+}
+
+EmbeddedSolver::EmbeddedSolver(const EmbeddedSolver& init) : Glucose::SimpSolver(init), nTrailPosition(init.nTrailPosition), id(init.id) {
+    assert(decisionLevel() == 0);
+    init.conflictFromPropagators.copyTo(conflictFromPropagators);
+    // copied propagators register their watches again
+    watchers.growTo(init.watchers.size());
+    reasonRequests.growTo(init.reasonRequests.size(), 0);
+}
+
+Var EmbeddedSolver::newVar(bool polarity, bool dvar) {
+    watchers.push();
+    watchers.push();
+    reasonRequests.push(0);
+    return Glucose::SimpSolver::newVar(polarity, dvar);
+}
+
+lbool EmbeddedSolver::solveWithBudget() {
+    conflict.clear();
+    if(!ok) return l_False;
+    lbool status = l_Undef;
+    int curr_restarts = 0;
+    while(status == l_Undef) {
+        status = search(
+                luby_restart ? luby(restart_inc, curr_restarts) * luby_restart_factor : 0); // the parameter is useless in glucose, kept to allow modifications
+
+        if(!withinBudget()) break;
+        curr_restarts++;
+    }
+    if(status == l_False && conflict.size() == 0) ok = false;
+    return status;
+}
+
+void EmbeddedSolver::cancelUntil(int level) {
+    if(decisionLevel() <= level) return;
+    trace_(5, "Cancel until " << level);
+    Glucose::SimpSolver::cancelUntil(level);
+    for(int i = 0; i < propagators.size(); i++) propagators[i]->onCancel();
+    resetTrailPositions();
+}
+
+void EmbeddedSolver::uncheckedEnqueueFromPropagator(Lit lit, Propagator* propagator) {
+    assert(propagator != NULL);
+    assert(value(lit) == l_Undef);
+    uncheckedEnqueue(lit);
+    assert(nTrailPosition + 1 == nAssigns());
+    VarData& data = vardata[var(lit)];
+    data.trailPosition = nTrailPosition++;
+    data.propagator = propagator->index;
+}
+
+void EmbeddedSolver::uncheckedEnqueueFromPropagator(vec<Lit>& lits, Propagator* propagator) {
+    assert(propagator != NULL);
+    assert(lits.size() > 0);
+    for(int i = 0; i < lits.size(); i++) {
+        Lit lit = lits[i];
+        assert(value(lit) == l_Undef);
+        uncheckedEnqueue(lit);
+        assert(nTrailPosition + i + 1 == nAssigns());
+        VarData& data = vardata[var(lit)];
+        data.trailPosition = nTrailPosition;
+        data.propagator = propagator->index;
+    }
+    nTrailPosition += lits.size();
+}
+
+void EmbeddedSolver::add(Propagator* ph) {
+    assert(ph != NULL);
+    ph->index = propagatorsByIndex.size();
+    propagatorsByIndex.push(ph);
+    propagators.push(ph);
+    for(int i = propagators.size() - 1; i > 0 && propagators[i-1]->priority > ph->priority; i--) {
+        propagators[i] = propagators[i-1];
+        propagators[i-1] = ph;
+    }
+}
+
+void EmbeddedSolver::watch(Lit lit, Propagator* ph) {
+    assert(ph != NULL);
+    propagatorWatches[toInt(lit)] = 1;
+    watchers[toInt(lit)].push(ph);
+}
+
+bool EmbeddedSolver::activatePropagators() {
+    assert(decisionLevel() == 0);
+    updateTrailPositions();
+    for(int i = 0; i < propagators.size(); i++) if(!propagators[i]->activate()) return false;
+    return true;
+}
+
+void EmbeddedSolver::updateTrailPositions() {
+    while(nTrailPosition < nAssigns()) {
+        trace_(50, "Trail index of " << assigned(nTrailPosition) << "@" << level(var(assigned(nTrailPosition))) << " is " << nTrailPosition);
+        vardata[var(assigned(nTrailPosition))].trailPosition = nTrailPosition;
+        nTrailPosition++;
+    }
+}
+
+bool EmbeddedSolver::simplifyPropagators() {
+    assert(decisionLevel() == 0);
+    updateTrailPositions();
+
+    int n = nAssigns();
+    for(int i = 0; i < propagators.size(); i++) {
+        if(!propagators[i]->simplify()) return ok = false;
+        if(nAssigns() > n) break;
+    }
+    return true;
+}
+
+bool EmbeddedSolver::propagatePropagators() {
+    if(decisionLevel() == 0) return simplifyPropagators();
+
+    assert(decisionLevel() > 0);
+    updateTrailPositions();
+
+    int n = nAssigns();
+    for(int i = 0; i < propagators.size(); i++) {
+        if(!propagatePropagator(i)) return false;
+        if(nAssigns() > n) break;
+    }
+    return true;
+}
+
+bool EmbeddedSolver::propagatePropagatorWatches(Lit lit) {
+    updateTrailPositions();
+    
+    vec<Propagator*>& ws = watchers[toInt(lit)];
+    for(int i = 0; i < ws.size(); i++) {
+        if(ws[i]->onWatched(lit)) continue;
+        // at level 0 the conflict is not analyzed
+        if(decisionLevel() > 0) { conflictFromPropagators.clear(); ws[i]->getConflict(conflictFromPropagators); }
+        return false;
+    }
+    return true;
+}
+
+bool EmbeddedSolver::propagatePropagator(int index) {
+    Propagator* p = propagators[index];
+    // the cost of non-cheap propagators is sampled once every COST_SAMPLING calls, so that reading the clock does not slow down propagation
+    bool sampled = p->priority != Propagator::PRIORITY_CHEAP && p->calls++ % COST_SAMPLING == 0;
+    bool timed = sampled;
+    statistics(timed = true;)
+    
+    if(!timed) {
+        if(p->propagate()) return true;
+        conflictFromPropagators.clear();
+        p->getConflict(conflictFromPropagators);
+        return false;
+    }
+    
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool res = p->propagate();
+    double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    statistics(propagatorsTime[p->priority] += time; propagatorsCalls[p->priority]++;)
+    
+    if(sampled) {
+        p->cost = (p->cost * 7 + time) / 8;
+        if(index > 0 && propagators[index-1]->priority == p->priority && propagators[index-1]->cost > p->cost) {
+            propagators[index] = propagators[index-1];
+            propagators[index-1] = p;
+        }
+    }
+    
+    if(!res) { conflictFromPropagators.clear(); p->getConflict(conflictFromPropagators); }
+    return res;
+}
+
+#ifdef STATS_ON
+void EmbeddedSolver::printStatistics() const {
+    static const char* names[Propagator::PRIORITIES] = {"cheap", "medium", "expensive"};
+    for(int i = 0; i < Propagator::PRIORITIES; i++) {
+        if(propagatorsCalls[i] == 0) continue;
+        print_statistics(solver, (id != "" ? "[" + id + "]" : "") << names[i] << " propagators: " << propagatorsTime[i] << " s in " << propagatorsCalls[i] << " calls");
+    }
+    print_statistics(solver, (id != "" ? "[" + id + "]" : "") << "explanations from propagators: " << explanations << " (" << explanationsAllocations << " buffer allocations)");
+    print_statistics(solver, (id != "" ? "[" + id + "]" : "") << "reasons of propagators as clauses: " << stats[Glucose::propagatorReasonHits] << " hits, " << explanations << " misses, " << materializedReasons << " clauses");
+}
+#endif
+
+bool EmbeddedSolver::conflictPropagators(Glucose::vec<Lit>& conflict) {
+    if(conflictFromPropagators.size() == 0) return false;
+    conflictFromPropagators.copyTo(conflict);
+    conflictFromPropagators.clear();
+    return true;
+}
+
+bool EmbeddedSolver::reasonPropagators(Lit lit, Glucose::vec<Lit>& reason_) {
+    assert(reason(var(lit)) == CRef_Undef);
+    Propagator* propagator = reasonFromPropagator(var(lit));
+    if(propagator == NULL) return false;
+    statistics(int capacity = reasonBuffer.capacity() + reason_.capacity();)
+    reasonBuffer.clear();
+    propagator->getReason(lit, reasonBuffer);
+    assert(reasonBuffer.size() > 0);
+    assert(reasonBuffer[0] == lit);
+    reasonBuffer.copyTo(reason_);
+    statistics(explanations++; if(reasonBuffer.capacity() + reason_.capacity() != capacity) explanationsAllocations++;)
+    cacheReason(reasonBuffer);
+    return true;
+}
+
+void EmbeddedSolver::cacheReason(vec<Lit>& lits) {
+    assert(lits.size() > 0);
+    Var v = var(lits[0]);
+    if(option_reason_cache == 0 || ++reasonRequests[v] < option_reason_cache) return;
+    reasonRequests[v] = 0;
+    if(lits.size() < 2) return;
+    
+    // the inferred literal is watched together with the false literal of highest level
+    int max = 1;
+    for(int i = 2; i < lits.size(); i++) if(level(var(lits[i])) > level(var(lits[max]))) max = i;
+    Lit tmp = lits[1];
+    lits[1] = lits[max];
+    lits[max] = tmp;
+    
+    CRef cr = ca.alloc(lits, true);
+    Clause& c = ca[cr];
+    c.setLBD(computeLBD(c));
+    c.setOneWatched(false);
+    c.setFromPropagator(true);
+#ifdef INCREMENTAL
+    c.setSizeWithoutSelectors(lits.size());
+#endif
+    learnts.push(cr);
+    claBumpActivity(c);
+    attachClause(cr);
+    vardata[v].reason = cr;
+    trace_(20, "Reason of " << lits[0] << " turned into clause " << lits);
+    statistics(materializedReasons++;)
+}
+
+bool EmbeddedSolver::reasonPropagators(Lit lit) {
+    assert(decisionLevel() != 0);
+    assert(reason(var(lit)) == CRef_Undef);
+    Propagator* propagator = reasonFromPropagator(var(lit));
+    if(propagator == NULL) return false;
+
+    vec<Lit>& clause = reasonBuffer;
+    statistics(int capacity = clause.capacity();)
+    clause.clear();
+    propagator->getReason(lit, clause);
+    statistics(explanations++; if(clause.capacity() != capacity) explanationsAllocations++;)
+
+    assert(clause.size() > 0);
+    assert(clause[0] == lit);
+    assert(reason(var(clause[0])) == CRef_Undef);
+
+    for(int i = 1; i < clause.size(); i++) {
+        Lit l = clause[i];
+        assert(value(l) == l_False);
+        assert(level(var(l)) <= level(var(clause[0])));
+        if(level(var(l)) > 0) seen[var(l)] = 1;
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,111 @@
+/*
+ *  Copyright (C) 2017  Mario Alviano (mario@alviano.net)
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#ifndef zuccherino_embedded_solver_h
+#define zuccherino_embedded_solver_h
+
+#include "utils/common.h"
+
+#include "Propagator.h"
+
+namespace zuccherino {
+
+// A solver with propagators and assumptions, but no parser and no printer.
+// It is the base of GlucoseWrapper, and can be used directly by solvers embedded in propagators or in other solvers.
+class EmbeddedSolver : public Glucose::SimpSolver {
+public:
+    EmbeddedSolver();
+    EmbeddedSolver(const EmbeddedSolver& init);
+
+    bool interrupted() const { return asynch_interrupt; }
+
+    virtual Var newVar(bool polarity = true, bool dvar = true);
+
+    void uncheckedEnqueueFromPropagator(Lit lit, Propagator* propagator);
+    void uncheckedEnqueueFromPropagator(vec<Lit>& lits, Propagator* propagator);
+
+    using Glucose::SimpSolver::decisionLevel;
+    using Glucose::SimpSolver::level;
+    inline Lit assigned(int index) const { return trail[index]; }
+    inline int assignedIndex(Var var) const { return vardata[var].trailPosition; }
+    inline int assignedIndex(Lit lit) const { return vardata[var(lit)].trailPosition; }
+
+    lbool solveWithBudget();
+
+    virtual void cancelUntil(int level);
+
+    virtual bool simplifyPropagators();
+    virtual bool propagatePropagators();
+    virtual bool propagatePropagatorWatches(Lit lit);
+    virtual bool conflictPropagators(Glucose::vec<Lit>& conflict);
+    virtual bool reasonPropagators(Lit lit, Glucose::vec<Lit>& reason);
+    virtual bool reasonPropagators(Lit lit);
+
+    inline bool addEmptyClause() { vec<Lit> tmp; return addClause_(tmp); }
+    void add(Propagator* ph);
+    void watch(Lit lit, Propagator* ph);
+    bool activatePropagators();
+
+    inline void setId(const string& value) { id = value; }
+
+protected:
+    int nTrailPosition;
+    vec<Lit> conflictFromPropagators;
+    // scratch buffer for reasons of propagators, reused to avoid allocations in conflict analysis
+    vec<Lit> reasonBuffer;
+    // requests of reasons for each variable since its last reason was turned into a clause
+    vec<int> reasonRequests;
+    // propagators woken up by Solver::propagate, indexed by toInt(lit)
+    vec< vec<Propagator*> > watchers;
+    // prefix of traces and statistics
+    string id;
+
+    // the propagator that inferred v, if any; stored as an index in vardata
+    inline Propagator* reasonFromPropagator(Var v) const { return vardata[v].propagator == -1 ? NULL : propagatorsByIndex[vardata[v].propagator]; }
+
+    void updateTrailPositions();
+    void cacheReason(vec<Lit>& reason);
+
+#ifdef STATS_ON
+    // reasons computed by propagators, and how many of them had to grow the scratch buffers
+    uint64_t explanations = 0;
+    uint64_t explanationsAllocations = 0;
+    void printStatistics() const;
+#endif
+    inline void resetTrailPositions() { while(nTrailPosition > nAssigns()) vardata[var(assigned(--nTrailPosition))].trailPosition = INT_MAX; }
+
+private:
+    // sorted by priority class; propagators of the same class are sorted by measured cost
+    vec<Propagator*> propagators;
+    // in order of addition
+    vec<Propagator*> propagatorsByIndex;
+    
+    static const unsigned COST_SAMPLING = 16;
+
+    bool propagatePropagator(int index);
+
+#ifdef STATS_ON
+    double propagatorsTime[Propagator::PRIORITIES] = {};
+    uint64_t propagatorsCalls[Propagator::PRIORITIES] = {};
+    uint64_t materializedReasons = 0;
+#endif
+};
+
+} // zuccherino
+
+
+#endif
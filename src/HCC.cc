@@ -17,31 +17,59 @@
 
 #include "HCC.h"
 
-#include "GlucoseWrapper.h"
+#include "EmbeddedSolver.h"
+
+#include <mtl/Sort.h>
+
+Glucose::IntOption option_hcc_check("HCC", "hcc-check",
+    "When unfounded sets of head-cycle components are checked: "
+    "0: after any assignment of the component; "
+    "1: only when all atoms and literals of the component are assigned; "
+    "2: also every hcc-check-levels decision levels; "
+    "3: also during search, skipping more checks while they infer nothing.", 0, Glucose::IntRange(0, 3));
+Glucose::IntOption option_hcc_threads("HCC", "hcc-threads", "Number of threads running in parallel the checks of head-cycle components affected by the same propagation.", 1, Glucose::IntRange(1, INT32_MAX));
+Glucose::IntOption option_hcc_check_levels("HCC", "hcc-check-levels", "Decision levels between checks of policy 2.", 8, Glucose::IntRange(1, INT32_MAX));
 
 namespace zuccherino {
 
+// Each assumption is decided at its own level (a dummy level if it is already true), and levels of search follow the assumptions.
 lbool HCC::UsSolver::solve(vec<Lit>& assumptions_) {
-    cancelUntil(0);
+    int kept = 0;
+    while(kept < decisionLevel() && kept < assumptions.size() && kept < assumptions_.size() && assumptions[kept] == assumptions_[kept]) kept++;
+    cancelUntil(kept);
+    keptAssumptions += kept;
+    trace(hcc, 30, "Keep " << kept << " of " << assumptions_.size() << " assumptions");
     assumptions_.moveTo(assumptions);
-    return GlucoseWrapper::solveWithBudget();
+    lbool status = EmbeddedSolver::solveWithBudget();
+    // search stops on a conflict at the level of an assumption without completing its propagation, so that level cannot be kept
+    if(status == l_False && decisionLevel() > 0) cancelUntil(decisionLevel() - 1);
+    return status;
 }
 
-HCC::HCC(GlucoseWrapper& solver, const HCC& init) : Propagator(solver, init), usSolver(init.usSolver), nextToPropagate(init.nextToPropagate), conflictLit(init.conflictLit), data(init.data) {
+HCC::HCC(EmbeddedSolver& solver, const HCC& init) : Propagator(solver, init), usSolver(init.usSolver), checkPolicy(init.checkPolicy), checkLevels(init.checkLevels), nextToPropagate(init.nextToPropagate), conflictLit(init.conflictLit), data(init.data) {
     init.rules.copyTo(rules);
 }
 
-HCC::HCC(GlucoseWrapper& solver, int id) : Propagator(solver), nextToPropagate(0), conflictLit(lit_Undef) { 
+HCC::HCC(EmbeddedSolver& solver, int id) : Propagator(solver, PRIORITY_EXPENSIVE), checkPolicy(option_hcc_check), checkLevels(option_hcc_check_levels), nextToPropagate(0), conflictLit(lit_Undef) { 
     stringstream ss;
     ss << "HCC " << id;
     usSolver.setId(ss.str());
 }
 
+// usSolver is back to level 0 with solver, as solver can be copied only at level 0
 void HCC::onCancel() {
     nextToPropagate = solver.nAssigns();    
+    if(solver.decisionLevel() == 0) usSolver.cancelUntil(0);
 }
 
 bool HCC::propagate_() {
+    if(!prepareCheck()) return true;
+    runCheck();
+    return applyCheck();
+}
+
+// the check is split in three parts, so that the checks of several components can run in parallel (runCheck() only accesses usSolver)
+bool HCC::prepareCheck() {
     assert(flagged.size() == 0);
     assert(conflictLit == lit_Undef);
     
@@ -55,21 +83,42 @@ bool HCC::propagate_() {
         nextToPropagate++;
     }
     
-    if(!check) return true;
-    trace(hcc, 10, "Running check");
+    if(check) pending = true;
+    if(!pending) return false;
+    partial = !isTotal();
+    if(partial && !checkPartial()) return false;
+    pending = false;
+    trace(hcc, 10, "Running " << (partial ? "partial" : "total") << " check");
+    checks++;
+    if(partial) partialChecks++;
 
-    vec<Lit> ass;
+    // literals assigned earlier in solver are less likely to change, so assumptions sorted by trail position share a long prefix with the previous check
+    assumptions.clear();
     for(int i = 0; i < data.vars(); i++) {
         Var v = data.var(i);
-        ass.push(solver.value(v) != l_True ? ~usLit(v) : usLit(v));
+        addAssumption(v, solver.value(v) != l_True ? ~usLit(v) : usLit(v));
     }
     for(int i = 0; i < data.lits(); i++) {
         Lit l = data.lit(i);
-        ass.push(solver.value(l) != l_False ? usLit(l) : ~usLit(l));
+        addAssumption(var(l), solver.value(l) != l_False ? usLit(l) : ~usLit(l));
     }
-    trace(hcc, 30, "with assumptions " << ass);
-    lbool status = usSolver.solve(ass);
+    Glucose::sort(assumptions, AssumptionLt());
+    checkAssumptions.clear();
+    for(int i = 0; i < assumptions.size(); i++) checkAssumptions.push(assumptions[i].lit);
+    trace(hcc, 30, "with assumptions " << checkAssumptions);
+    return true;
+}
+
+void HCC::runCheck() {
+    status = usSolver.solve(checkAssumptions);
     trace(hcc, 40, "result: " << status);
+}
+
+bool HCC::applyCheck() {
+    if(partial) {
+        if(status == l_True) { usefulPartialChecks++; if(checkInterval > 1) checkInterval /= 2; }
+        else if(checkInterval < MAX_CHECK_INTERVAL) checkInterval *= 2;
+    }
     if(status == l_True) {
         vec<Lit> lits;
         for(int i = 0; i < data.vars(); i++) {
@@ -94,13 +143,45 @@ bool HCC::propagate_() {
     return true;
 }
 
+// unassigned variables follow the assigned ones in a fixed order
+void HCC::addAssumption(Var v, Lit lit) {
+    uint64_t position = solver.value(v) == l_Undef ? INT_MAX : solver.assignedIndex(v);
+    assumptions.push();
+    assumptions.last().key = (position << 32) | assumptions.size();
+    assumptions.last().lit = lit;
+}
+
+// a check on a total assignment of the component is required, as it is the only one detecting true atoms in an unfounded set
+bool HCC::isTotal() const {
+    if(solver.decisionLevel() == 0) return true;
+    for(int i = 0; i < data.vars(); i++) if(solver.value(data.var(i)) == l_Undef) return false;
+    for(int i = 0; i < data.lits(); i++) if(solver.value(data.lit(i)) == l_Undef) return false;
+    return true;
+}
+
+bool HCC::checkPartial() {
+    switch(checkPolicy) {
+    case CHECK_ALWAYS: return true;
+    case CHECK_TOTAL: return false;
+    case CHECK_LEVELS: return solver.decisionLevel() % checkLevels == 0;
+    default:
+        assert(checkPolicy == CHECK_ADAPTIVE);
+        if(++skippedChecks < checkInterval) return false;
+        skippedChecks = 0;
+        return true;
+    }
+}
+
 bool HCC::simplify() {
     assert(solver.decisionLevel() == 0);
-    return propagate_();
+    bool res = propagate_();
+    usSolver.cancelUntil(0);
+    return res;
 }
 
 bool HCC::propagate() {
     assert(solver.decisionLevel() > 0);
+    if(scheduler != NULL) return scheduler->propagate(*this);
     return propagate_();
 }
 
@@ -170,7 +251,9 @@ bool HCC::activate() {
         lits.clear();
     }
     
-    if(!propagate_()) return solver.addEmptyClause();
+    bool res = propagate_();
+    usSolver.cancelUntil(0);
+    if(!res) return solver.addEmptyClause();
     return true;
 }
 
@@ -201,6 +284,8 @@ void HCC::getReason(Lit lit, vec<Lit>& ret) {
 }
 
 void HCC::getConflict(vec<Lit>& ret) {
+    // the conflict may come from another component checked in the same round
+    if(scheduler != NULL && scheduler->conflicting != this) { scheduler->conflicting->getConflict(ret); return; }
     assert(ret.size() == 0);
     assert(sign(conflictLit));
     assert(flagged.size() > 0);
@@ -220,7 +305,8 @@ void HCC::computeReason(Lit lit, vec<Lit>& ret) {
     trace(hcc, 20, "Computing reason for " << lit);
     
     ret.push(lit);
-    vec<Var> stack;
+    vec<Var>& stack = reasonStack;
+    assert(stack.size() == 0);
     stack.push(var(lit));
     do{
         Var v = stack.last();
@@ -253,4 +339,39 @@ void HCC::computeReason(Lit lit, vec<Lit>& ret) {
     resetFlagged2();
 }
 
+HCCScheduler::HCCScheduler(int threads) : pool(threads - 1), conflicting(NULL) {
+}
+
+void HCCScheduler::add(HCC* hcc) {
+    assert(hcc->scheduler == NULL);
+    hcc->scheduler = this;
+    hccs.push(hcc);
+}
+
+// Components are disjoint, so the inferences of a component do not change the values of the atoms of the others:
+// their checks are still valid, as unfounded sets remain unfounded when more literals are false.
+// Checks after the first conflict are discarded, and their components are checked again at the next propagation.
+bool HCCScheduler::propagate(HCC& caller) {
+    ready.clear();
+    for(int i = 0; i < hccs.size(); i++) if(hccs[i]->prepareCheck()) ready.push(hccs[i]);
+    if(ready.size() == 0) return true;
+    trace(hcc, 10, "Run " << ready.size() << " checks in parallel");
+    for(int i = 1; i < ready.size(); i++) {
+        HCC* hcc = ready[i];
+        pool.run([hcc]() { hcc->runCheck(); });
+    }
+    ready[0]->runCheck();
+    pool.wait();
+    if(ready.size() > 1) parallelChecks += ready.size();
+
+    conflicting = &caller;
+    for(int i = 0; i < ready.size(); i++) {
+        if(ready[i]->applyCheck()) continue;
+        conflicting = ready[i];
+        for(int j = i + 1; j < ready.size(); j++) ready[j]->pending = true;
+        return false;
+    }
+    return true;
+}
+
 }
@@ -20,13 +20,18 @@
 
 #include "Data.h"
 #include "CardinalityConstraint.h"
+#include "StaticSolver.h"
+#include "utils/ThreadPool.h"
 
 namespace zuccherino {
 
+class HCCScheduler;
+
 class HCC: public Propagator {
+    friend class HCCScheduler;
 public:
-    HCC(GlucoseWrapper& solver, int id);
-    HCC(GlucoseWrapper& solver, const HCC& init);
+    HCC(EmbeddedSolver& solver, int id);
+    HCC(EmbeddedSolver& solver, const HCC& init);
     
     virtual bool activate();
     
@@ -39,17 +44,58 @@ public:
 
     void add(vec<Var>& recHead, vec<Lit>& nonRecLits, vec<Var>& recBody);
 
+    inline uint64_t getChecks() const { return checks; }
+    // checks on partial assignments of the component, and those inferring some literal
+    inline uint64_t getPartialChecks() const { return partialChecks; }
+    inline uint64_t getUsefulPartialChecks() const { return usefulPartialChecks; }
+    // propagations of usSolver, summed over all checks
+    inline uint64_t getCheckPropagations() const { return usSolver.propagations; }
+    // assumptions of checks whose levels were kept from the previous check
+    inline uint64_t getKeptAssumptions() const { return usSolver.getKeptAssumptions(); }
+
 private:
-    class UsSolver : public GlucoseWrapper {
+    class UsSolver : public StaticEmbeddedSolver<CardinalityConstraintPropagator> {
     public:
-        inline UsSolver() : ccPropagator(*this) {}
+        inline UsSolver() : ccPropagator(*this) { setPropagators(ccPropagator); }
+        inline UsSolver(const UsSolver& init) : StaticEmbeddedSolver<CardinalityConstraintPropagator>(init), ccPropagator(*this, init.ccPropagator) { setPropagators(ccPropagator); }
         inline bool addGreaterEqual(vec<Lit>& lits, int bound) { return ccPropagator.addGreaterEqual(lits, bound); }
+        // the levels of the longest prefix of assumptions shared with the previous call are kept, so that only the others are propagated
         lbool solve(vec<Lit>& assumptions);
+        inline uint64_t getKeptAssumptions() const { return keptAssumptions; }
     private:
         CardinalityConstraintPropagator ccPropagator;
+        uint64_t keptAssumptions = 0;
     };
     
     UsSolver usSolver;
+    // assumptions of the next check, sorted by position in the trail of solver
+    struct Assumption {
+        uint64_t key;
+        Lit lit;
+    };
+    struct AssumptionLt {
+        inline bool operator()(const Assumption& a, const Assumption& b) const { return a.key < b.key; }
+    };
+    vec<Assumption> assumptions;
+    vec<Lit> checkAssumptions;
+    bool partial = false;
+    lbool status;
+    uint64_t checks = 0;
+    uint64_t partialChecks = 0;
+    uint64_t usefulPartialChecks = 0;
+    
+    // values of option hcc-check
+    enum CheckPolicy { CHECK_ALWAYS, CHECK_TOTAL, CHECK_LEVELS, CHECK_ADAPTIVE };
+    int checkPolicy;
+    int checkLevels;
+    // some literal was assigned since the last check
+    bool pending = false;
+    // NULL if checks are run by propagate()
+    HCCScheduler* scheduler = NULL;
+    // policy CHECK_ADAPTIVE runs one of checkInterval partial checks, doubled when a check infers nothing and halved otherwise
+    static const int MAX_CHECK_INTERVAL = 1024;
+    int checkInterval = 1;
+    int skippedChecks = 0;
     
     int nextToPropagate;
     Lit conflictLit;
@@ -86,16 +132,44 @@ private:
     
     vec<Var> flagged;
     vec<Var> flagged2;
+    vec<Var> reasonStack;
     bool addToFlagged(Var v);
     void resetFlagged();
     bool addToFlagged2(Var v);
     void resetFlagged2();
     bool addToSpLost(Var v);
     
+    void addAssumption(Var v, Lit lit);
+    bool isTotal() const;
+    bool checkPartial();
     bool propagate_();
+    bool prepareCheck();
+    void runCheck();
+    bool applyCheck();
     void computeReason(Lit lit, vec<Lit>& ret);
 };
 
+// runs in parallel the checks of the components affected by a propagation, merging their inferences and the first conflict
+class HCCScheduler {
+    friend class HCC;
+public:
+    explicit HCCScheduler(int threads);
+    
+    void add(HCC* hcc);
+    bool propagate(HCC& caller);
+    
+    // checks run in rounds of at least two components
+    inline uint64_t getParallelChecks() const { return parallelChecks; }
+
+private:
+    ThreadPool pool;
+    vec<HCC*> hccs;
+    vec<HCC*> ready;
+    // the component whose conflict is returned by the caller of propagate()
+    HCC* conflicting;
+    uint64_t parallelChecks = 0;
+};
+
 }
 
 #endif
@@ -0,0 +1,186 @@
+/*
+ *  Copyright (C) 2017  Mario Alviano (mario@alviano.net)
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include "HittingSet.h"
+
+#include <mtl/Sort.h>
+
+namespace zuccherino {
+
+struct CostLt {
+    const vec<int64_t>& costs;
+    CostLt(const vec<int64_t>& costs_) : costs(costs_) {}
+    bool operator()(int a, int b) const { return costs[a] < costs[b]; }
+};
+
+struct SizeLt {
+    const vec<vec<int> >& sets;
+    SizeLt(const vec<vec<int> >& sets_) : sets(sets_) {}
+    bool operator()(int a, int b) const { return sets[a].size() < sets[b].size(); }
+};
+
+HittingSet::HittingSet(const bool& interrupted_) : interrupted(interrupted_), currentCost(0), bestCost(0), minCost(0), nodes(0), nodesLimit(0) {
+}
+
+int HittingSet::addElement(int64_t cost) {
+    assert(cost > 0);
+    costs.push(cost);
+    occurrences.push();
+    excluded.push(false);
+    residual.push(cost);
+    return costs.size() - 1;
+}
+
+void HittingSet::addSet(const vec<int>& elements) {
+    assert(elements.size() > 0);
+    int s = sets.size();
+    sets.push();
+    elements.copyTo(sets.last());
+    for(int i = 0; i < elements.size(); i++) occurrences[elements[i]].push(s);
+    hits.push(0);
+    available.push(elements.size());
+    order.push(s);
+}
+
+int64_t HittingSet::solveGreedy(vec<int>& solution) {
+    solution.clear();
+    int64_t cost = 0;
+    vec<int> unhit;
+    unhit.growTo(costs.size(), 0);
+    for(int i = 0; i < sets.size(); i++) for(int j = 0; j < sets[i].size(); j++) unhit[sets[i][j]]++;
+    vec<bool> hit;
+    hit.growTo(sets.size(), false);
+    for(;;) {
+        int pick = -1;
+        for(int i = 0; i < costs.size(); i++) {
+            if(unhit[i] == 0) continue;
+            if(pick == -1 || static_cast<double>(unhit[i]) / costs[i] > static_cast<double>(unhit[pick]) / costs[pick]) pick = i;
+        }
+        if(pick == -1) break;
+        solution.push(pick);
+        cost += costs[pick];
+        for(int i = 0; i < occurrences[pick].size(); i++) {
+            int s = occurrences[pick][i];
+            if(hit[s]) continue;
+            hit[s] = true;
+            for(int j = 0; j < sets[s].size(); j++) unhit[sets[s][j]]--;
+        }
+    }
+    return cost;
+}
+
+lbool HittingSet::solveOptimal(int64_t min, int64_t bound, uint64_t budget, vec<int>& solution, int64_t& cost) {
+    assert(current.size() == 0 && currentCost == 0);
+    Glucose::sort(order, SizeLt(sets));
+    best.clear();
+    bestCost = bound;
+    minCost = min;
+    // the greedy hitting set is a first incumbent
+    vec<int> greedy;
+    int64_t greedyCost = solveGreedy(greedy);
+    if(greedyCost < bestCost) { bestCost = greedyCost; greedy.moveTo(best); }
+
+    nodesLimit = nodes + budget;
+    bool completed = search();
+    assert(current.size() == 0 && currentCost == 0);
+
+    cost = bestCost;
+    best.copyTo(solution);
+    if(!completed) return l_Undef;
+    return bestCost < bound ? l_True : l_False;
+}
+
+void HittingSet::select(int element) {
+    current.push(element);
+    currentCost += costs[element];
+    for(int i = 0; i < occurrences[element].size(); i++) hits[occurrences[element][i]]++;
+}
+
+void HittingSet::unselect(int element) {
+    assert(current.last() == element);
+    current.pop();
+    currentCost -= costs[element];
+    for(int i = 0; i < occurrences[element].size(); i++) hits[occurrences[element][i]]--;
+}
+
+void HittingSet::exclude(int element) {
+    excluded[element] = true;
+    for(int i = 0; i < occurrences[element].size(); i++) available[occurrences[element][i]]--;
+}
+
+void HittingSet::include(int element) {
+    excluded[element] = false;
+    for(int i = 0; i < occurrences[element].size(); i++) available[occurrences[element][i]]++;
+}
+
+// each unhit set takes the minimum residual cost of its available elements, which is then subtracted from all of them
+int64_t HittingSet::lowerBound(int64_t limit) {
+    for(int i = 0; i < sets.size(); i++) {
+        if(hits[i] > 0) continue;
+        for(int j = 0; j < sets[i].size(); j++) residual[sets[i][j]] = costs[sets[i][j]];
+    }
+    int64_t sum = 0;
+    for(int k = 0; k < order.size() && sum < limit; k++) {
+        int i = order[k];
+        if(hits[i] > 0) continue;
+        int64_t min = INT64_MAX;
+        for(int j = 0; j < sets[i].size(); j++) if(!excluded[sets[i][j]] && residual[sets[i][j]] < min) min = residual[sets[i][j]];
+        assert(min != INT64_MAX);
+        if(min == 0) continue;
+        sum += min;
+        for(int j = 0; j < sets[i].size(); j++) if(!excluded[sets[i][j]]) residual[sets[i][j]] -= min;
+    }
+    return sum;
+}
+
+bool HittingSet::search() {
+    if(++nodes > nodesLimit || interrupted) return false;
+
+    int pick = -1;
+    for(int i = 0; i < sets.size(); i++) {
+        if(hits[i] > 0) continue;
+        if(available[i] == 0) return true;
+        if(pick == -1 || available[i] < available[pick]) pick = i;
+    }
+    if(pick == -1) {
+        assert(currentCost < bestCost);
+        trace(maxsat, 20, "Hitting set of cost " << currentCost);
+        bestCost = currentCost;
+        current.copyTo(best);
+        return true;
+    }
+    if(currentCost + lowerBound(bestCost - currentCost) >= bestCost) return true;
+
+    vec<int> branch;
+    for(int i = 0; i < sets[pick].size(); i++) if(!excluded[sets[pick][i]]) branch.push(sets[pick][i]);
+    Glucose::sort(branch, CostLt(costs));
+
+    // the i-th branch selects the i-th element and excludes the previous ones
+    bool completed = true;
+    int i = 0;
+    for(; i < branch.size() && completed && bestCost > minCost; i++) {
+        if(currentCost + costs[branch[i]] >= bestCost) break;
+        select(branch[i]);
+        completed = search();
+        unselect(branch[i]);
+        exclude(branch[i]);
+    }
+    while(i > 0) include(branch[--i]);
+    return completed;
+}
+
+}
@@ -0,0 +1,79 @@
+/*
+ *  Copyright (C) 2017  Mario Alviano (mario@alviano.net)
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#ifndef zuccherino_hitting_set_h
+#define zuccherino_hitting_set_h
+
+#include "utils/common.h"
+
+namespace zuccherino {
+
+// Minimum-cost hitting sets of a growing family of sets of elements, computed by branch and bound so that no external ILP solver is needed.
+// Nodes branch on the available elements of an unhit set with fewest of them, and are pruned by the lower bound obtained by sharing the cost
+// of each element among the unhit sets containing it (a feasible solution of the dual of the LP relaxation).
+class HittingSet {
+public:
+    // the search stops when interrupted becomes true (usually the interrupt flag of the SAT solver)
+    explicit HittingSet(const bool& interrupted);
+
+    int addElement(int64_t cost);
+    void addSet(const vec<int>& elements);
+    inline int nSets() const { return sets.size(); }
+
+    // elements are chosen by decreasing ratio of unhit sets and cost
+    int64_t solveGreedy(vec<int>& solution);
+    // l_True if solution has minimum cost among the hitting sets of cost less than bound, l_False if there is no such hitting set,
+    // l_Undef if the budget of nodes is exhausted or the search is interrupted (solution is the best hitting set found, possibly empty);
+    // min is a known lower bound, so that the search stops as soon as a hitting set of cost min is found
+    lbool solveOptimal(int64_t min, int64_t bound, uint64_t budget, vec<int>& solution, int64_t& cost);
+
+    inline uint64_t getNodes() const { return nodes; }
+
+private:
+    const bool& interrupted;
+
+    vec<int64_t> costs;
+    vec<vec<int> > sets;
+    vec<vec<int> > occurrences;
+
+    // number of selected elements in each set, and number of elements of each set that are not excluded
+    vec<int> hits;
+    vec<int> available;
+    vec<bool> excluded;
+    vec<int64_t> residual;
+    // sets by increasing size, the order in which they contribute to the lower bound
+    vec<int> order;
+
+    vec<int> current;
+    int64_t currentCost;
+    vec<int> best;
+    int64_t bestCost;
+    int64_t minCost;
+    uint64_t nodes;
+    uint64_t nodesLimit;
+
+    void select(int element);
+    void unselect(int element);
+    void exclude(int element);
+    void include(int element);
+    int64_t lowerBound(int64_t limit);
+    bool search();
+};
+
+}
+
+#endif
@@ -0,0 +1,237 @@
+/*
+ *  Copyright (C) 2017  Mario Alviano (mario@alviano.net)
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include "LocalSearch.h"
+
+namespace zuccherino {
+
+LocalSearch::LocalSearch(int seed) : nVars(0), falsifiedEmptySoft(0), hasEmptyHard(false), cost(0), random(seed), interrupted(false), flips(0), improvements(0), bestCost(INT64_MAX) {
+    clauseStart.push(0);
+}
+
+LocalSearch::~LocalSearch() {
+    stop();
+}
+
+void LocalSearch::addClause(const vec<Lit>& lits, int64_t weight_) {
+    assert(!thread.joinable());
+    assert(weight_ >= 0);
+    if(lits.size() == 0) {
+        if(weight_ == 0) hasEmptyHard = true;
+        else falsifiedEmptySoft += weight_;
+        return;
+    }
+    int c = originalWeight.size();
+    // duplicated literals are skipped, and tautologies are discarded
+    for(int i = 0; i < lits.size(); i++) {
+        Var v = var(lits[i]);
+        if(v >= nVars) { nVars = v + 1; occurrences.growTo(nVars); inClause.growTo(2 * nVars, -1); }
+        if(inClause[toInt(~lits[i])] == c) {
+            for(int j = 0; j < i; j++) inClause[toInt(lits[j])] = -1;
+            return;
+        }
+        inClause[toInt(lits[i])] = c;
+    }
+    for(int i = 0; i < lits.size(); i++) {
+        Var v = var(lits[i]);
+        if(inClause[toInt(lits[i])] != c) continue;
+        inClause[toInt(lits[i])] = -1;
+        occurrences[v].push((c << 1) | sign(lits[i]));
+        clauseLits.push(lits[i]);
+    }
+    clauseStart.push(clauseLits.size());
+    originalWeight.push(weight_);
+}
+
+void LocalSearch::start() {
+    assert(!thread.joinable());
+    if(hasEmptyHard) return;
+    thread = std::thread([this]() { run(); });
+}
+
+void LocalSearch::stop() {
+    interrupt();
+    if(thread.joinable()) thread.join();
+}
+
+bool LocalSearch::importModel(int64_t upperBound, int64_t& cost_, vec<lbool>& model) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(bestCost >= upperBound) return false;
+    cost_ = bestCost;
+    bestModel.copyTo(model);
+    return true;
+}
+
+void LocalSearch::run() {
+    init();
+    int64_t best = INT64_MAX;
+    while(!interrupted) {
+        if(falsifiedHard.size() == 0 && cost < best) {
+            best = cost;
+            saveModel();
+            if(cost == 0) break;
+        }
+        int v = pickVar();
+        if(v == -1) break;
+        flip(v);
+        flipTime[v] = ++flips;
+    }
+}
+
+void LocalSearch::init() {
+    int nClauses = originalWeight.size();
+    value.growTo(nVars);
+    for(int i = 0; i < nVars; i++) value[i] = random() & 1;
+    score.growTo(nVars, 0);
+    flipTime.growTo(nVars, 0);
+    goodPos.growTo(nVars, -1);
+    weight.growTo(nClauses, 1);
+    satCount.growTo(nClauses, 0);
+    satVar.growTo(nClauses, -1);
+    falsifiedPos.growTo(nClauses, -1);
+    cost = falsifiedEmptySoft;
+
+    for(int c = 0; c < nClauses; c++) {
+        for(int i = 0; i < clauseSize(c); i++) {
+            if(!isTrue(clauseLit(c, i))) continue;
+            satCount[c]++;
+            satVar[c] = var(clauseLit(c, i));
+        }
+        if(satCount[c] == 0) {
+            setFalsified(c);
+            for(int i = 0; i < clauseSize(c); i++) score[var(clauseLit(c, i))] += weight[c];
+        }
+        else if(satCount[c] == 1) score[satVar[c]] -= weight[c];
+    }
+    for(int v = 0; v < nVars; v++) if(score[v] > 0) { goodPos[v] = goodVars.size(); goodVars.push(v); }
+}
+
+void LocalSearch::addScore(int v, int64_t delta) {
+    score[v] += delta;
+    if(score[v] > 0) {
+        if(goodPos[v] == -1) { goodPos[v] = goodVars.size(); goodVars.push(v); }
+    }
+    else if(goodPos[v] != -1) {
+        int last = goodVars.last();
+        goodVars[goodPos[v]] = last;
+        goodPos[last] = goodPos[v];
+        goodVars.pop();
+        goodPos[v] = -1;
+    }
+}
+
+void LocalSearch::setFalsified(int c) {
+    vec<int>& list = isHard(c) ? falsifiedHard : falsifiedSoft;
+    falsifiedPos[c] = list.size();
+    list.push(c);
+    cost += originalWeight[c];
+}
+
+void LocalSearch::setSatisfied(int c) {
+    vec<int>& list = isHard(c) ? falsifiedHard : falsifiedSoft;
+    int last = list.last();
+    list[falsifiedPos[c]] = last;
+    falsifiedPos[last] = falsifiedPos[c];
+    list.pop();
+    falsifiedPos[c] = -1;
+    cost -= originalWeight[c];
+}
+
+void LocalSearch::flip(int v) {
+    value[v] = !value[v];
+    vec<int>& occs = occurrences[v];
+    for(int i = 0; i < occs.size(); i++) {
+        int c = occs[i] >> 1;
+        Lit lit = mkLit(v, occs[i] & 1);
+        int64_t w = weight[c];
+        if(isTrue(lit)) {
+            satCount[c]++;
+            if(satCount[c] == 1) {
+                // no variable makes the clause true anymore, and v now breaks it
+                setSatisfied(c);
+                for(int j = 0; j < clauseSize(c); j++) addScore(var(clauseLit(c, j)), -w);
+                addScore(v, -w);
+                satVar[c] = v;
+            }
+            else if(satCount[c] == 2) addScore(satVar[c], w);
+        }
+        else {
+            satCount[c]--;
+            if(satCount[c] == 0) {
+                setFalsified(c);
+                for(int j = 0; j < clauseSize(c); j++) addScore(var(clauseLit(c, j)), w);
+                addScore(v, w);
+            }
+            else if(satCount[c] == 1) {
+                for(int j = 0; j < clauseSize(c); j++) {
+                    if(!isTrue(clauseLit(c, j))) continue;
+                    satVar[c] = var(clauseLit(c, j));
+                    addScore(satVar[c], -w);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// falsified hard clauses get heavier, and falsified soft clauses too up to a limit proportional to their original weight
+void LocalSearch::updateWeights() {
+    for(int i = 0; i < falsifiedHard.size(); i++) {
+        int c = falsifiedHard[i];
+        weight[c] += HARD_INCREMENT;
+        for(int j = 0; j < clauseSize(c); j++) addScore(var(clauseLit(c, j)), HARD_INCREMENT);
+    }
+    for(int i = 0; i < falsifiedSoft.size(); i++) {
+        int c = falsifiedSoft[i];
+        if(weight[c] >= SOFT_LIMIT) continue;
+        weight[c]++;
+        for(int j = 0; j < clauseSize(c); j++) addScore(var(clauseLit(c, j)), 1);
+    }
+}
+
+int LocalSearch::pickVar() {
+    if(goodVars.size() > 0) {
+        // best from multiple selections, preferring the least recently flipped variable
+        int best = goodVars[random() % goodVars.size()];
+        for(int i = 1; i < SAMPLES && i < goodVars.size(); i++) {
+            int v = goodVars[random() % goodVars.size()];
+            if(score[v] > score[best] || (score[v] == score[best] && flipTime[v] < flipTime[best])) best = v;
+        }
+        return best;
+    }
+
+    updateWeights();
+    vec<int>& list = falsifiedHard.size() > 0 ? falsifiedHard : falsifiedSoft;
+    if(list.size() == 0) return -1;
+    int c = list[random() % list.size()];
+    int best = var(clauseLit(c, 0));
+    for(int i = 1; i < clauseSize(c); i++) {
+        int v = var(clauseLit(c, i));
+        if(score[v] > score[best] || (score[v] == score[best] && flipTime[v] < flipTime[best])) best = v;
+    }
+    return best;
+}
+
+void LocalSearch::saveModel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    improvements++;
+    bestCost = cost;
+    bestModel.growTo(nVars);
+    for(int i = 0; i < nVars; i++) bestModel[i] = value[i] ? l_True : l_False;
+}
+
+}
@@ -0,0 +1,109 @@
+/*
+ *  Copyright (C) 2017  Mario Alviano (mario@alviano.net)
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#ifndef zuccherino_local_search_h
+#define zuccherino_local_search_h
+
+#include "utils/common.h"
+
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace zuccherino {
+
+// Stochastic local search for weighted partial MaxSAT in the style of SATLike: clauses have dynamic weights, increased when no flip improves the weighted
+// number of falsified clauses, and flips are chosen among the improving variables by best from multiple selections.
+// The search runs in its own thread on the input clauses, and the best assignment satisfying all hard clauses is collected by importModel().
+class LocalSearch {
+public:
+    LocalSearch(int seed = 0);
+    ~LocalSearch();
+
+    // weight 0 for hard clauses; clauses must be added before start()
+    void addClause(const vec<Lit>& lits, int64_t weight);
+
+    void start();
+    // only sets a flag, so it can be called by signal handlers
+    inline void interrupt() { interrupted = true; }
+    void stop();
+
+    // copies the best assignment found so far if its cost is less than upperBound
+    bool importModel(int64_t upperBound, int64_t& cost, vec<lbool>& model);
+
+    inline uint64_t getFlips() const { return flips; }
+    inline uint64_t getImprovements() const { return improvements; }
+
+private:
+    static const int SAMPLES = 15;
+    static const int64_t HARD_INCREMENT = 3;
+    static const int64_t SOFT_LIMIT = 1000;
+
+    int nVars;
+    vec<int> clauseStart;
+    vec<Lit> clauseLits;
+    vec<int64_t> originalWeight; // 0 for hard clauses
+    int64_t falsifiedEmptySoft;
+    bool hasEmptyHard;
+    // occurrences of each variable as clause index and sign
+    vec<vec<int> > occurrences;
+    // clause being added where each literal occurs (key toInt(lit)), -1 otherwise
+    vec<int> inClause;
+
+    vec<bool> value;
+    vec<int64_t> weight;
+    vec<int> satCount;
+    vec<int> satVar;
+    vec<int64_t> score;
+    vec<uint64_t> flipTime;
+    vec<int> falsifiedHard;
+    vec<int> falsifiedSoft;
+    vec<int> falsifiedPos;
+    vec<int> goodVars;
+    vec<int> goodPos;
+    int64_t cost;
+
+    std::mt19937 random;
+    std::thread thread;
+    std::atomic<bool> interrupted;
+    uint64_t flips;
+    uint64_t improvements;
+
+    std::mutex mutex;
+    int64_t bestCost;
+    vec<lbool> bestModel;
+
+    inline int clauseSize(int c) const { return clauseStart[c+1] - clauseStart[c]; }
+    inline Lit clauseLit(int c, int i) const { return clauseLits[clauseStart[c] + i]; }
+    inline bool isTrue(Lit lit) const { return value[var(lit)] != sign(lit); }
+    inline bool isHard(int c) const { return originalWeight[c] == 0; }
+
+    void run();
+    void init();
+    void flip(int v);
+    void addScore(int v, int64_t delta);
+    void setFalsified(int c);
+    void setSatisfied(int c);
+    void updateWeights();
+    int pickVar();
+    void saveModel();
+};
+
+}
+
+#endif
@@ -17,16 +17,44 @@
 
 #include "MaxSAT.h"
 
+#include "HittingSet.h"
+
 #include <core/Dimacs.h>
 
+#include <mutex>
+#include <thread>
+#include <vector>
+
 extern Glucose::IntOption option_n;
 extern Glucose::BoolOption option_print_model;
+extern Glucose::BoolOption option_restore_on_cancel;
 
 Glucose::BoolOption option_maxsat_top_k = Glucose::BoolOption("MAXSAT", "top-k", "Solve top-k problem.", false);
 Glucose::BoolOption option_maxsat_use_preferences = Glucose::BoolOption("MAXSAT", "use-preferences", "First assign variables introduced by the unsat core analysis.", false);
+Glucose::BoolOption option_maxsat_watched_cc = Glucose::BoolOption("MAXSAT", "watched-cc", "Propagate cardinality constraints by watching bound+1 literals instead of counting false literals.", false);
+Glucose::BoolOption option_maxsat_lazy_outputs = Glucose::BoolOption("MAXSAT", "lazy-outputs", "Create the outputs of the constraints introduced by core analysis one at a time, when the previous one occurs in a core.", false);
+Glucose::BoolOption option_maxsat_wce = Glucose::BoolOption("MAXSAT", "wce", "Delay the relaxation of cores until the solver finds a model (weight-aware core extraction).", false);
+Glucose::IntOption option_maxsat_strat = Glucose::IntOption("MAXSAT", "strat",
+    "0: no stratification; "
+    "1: one level per distinct weight; "
+    "2: diversity-based levels, merging weights until a level has strat-ratio soft literals per distinct weight; "
+    "3: geometric levels, each one covering weights up to strat-ratio times smaller than the largest one; ",
+    1, Glucose::IntRange(0, 3));
+Glucose::DoubleOption option_maxsat_strat_ratio = Glucose::DoubleOption("MAXSAT", "strat-ratio", "Ratio used by diversity-based and geometric stratification.", 2.0, Glucose::DoubleRange(1.0, true, HUGE_VAL, false));
+Glucose::IntOption option_maxsat_strat_max = Glucose::IntOption("MAXSAT", "strat-max", "Maximum number of stratification levels; the last one includes all soft literals (0 for no limit).", 0, Glucose::IntRange(0, INT32_MAX));
+Glucose::IntOption option_maxsat_linear_search = Glucose::IntOption("MAXSAT", "linear-search", "Conflicts of each phase of search for models improving the upper bound, alternated with core analysis at the end of stratification levels (0 to disable; ignored for top-k and enumeration).", 0, Glucose::IntRange(0, INT32_MAX));
+Glucose::IntOption option_maxsat_lns = Glucose::IntOption("MAXSAT", "lns", "Conflicts for each neighbourhood of the large-neighbourhood search run after each model improving the upper bound (0 to disable; ignored for top-k and enumeration).", 0, Glucose::IntRange(0, INT32_MAX));
+Glucose::BoolOption option_maxsat_ihs = Glucose::BoolOption("MAXSAT", "ihs", "Use the implicit hitting set algorithm instead of relaxing cores (ignored for top-k, enumeration and portfolio).", false);
+Glucose::BoolOption option_maxsat_local_search = Glucose::BoolOption("MAXSAT", "local-search", "Run a stochastic local search in a parallel thread to improve the upper bound and the phases of the solver (ignored for top-k and portfolio).", false);
+Glucose::IntOption option_maxsat_portfolio = Glucose::IntOption("MAXSAT", "portfolio", "Number of differently configured engines run in parallel threads, sharing bounds and hardened soft literals (ignored for top-k and enumeration).", 1, Glucose::IntRange(1, INT32_MAX));
+Glucose::IntOption option_maxsat_disjoint_cores = Glucose::IntOption("MAXSAT", "disjoint-cores", "Number of parallel threads searching for disjoint cores before the main loop, to raise the lower bound early (0 to disable; ignored with lazy-outputs and wce).", 0, Glucose::IntRange(0, INT32_MAX));
+Glucose::IntOption option_maxsat_shrink_threads = Glucose::IntOption("MAXSAT", "shrink-threads", "Number of parallel threads shrinking each core, each one with a different order of its literals; the smallest core is kept.", 1, Glucose::IntRange(1, INT32_MAX));
 
 namespace zuccherino {
 
+constexpr double MaxSAT::LNS_MIN_RATIO;
+constexpr double MaxSAT::LNS_MAX_RATIO;
+
 void MaxSATParserProlog::parseAttach(Glucose::StreamBuffer& in) {
     Parser::parseAttach(in);
     valid = false;
@@ -44,7 +72,7 @@ void MaxSATParserProlog::parse() {
     if(weighted) top = parseLong(in());
 
     while(solver.nVars() < nInputVars) solver.newVar();
-    solver.setLastVisibleVar(nInputVars);
+    solver.setInputVars(nInputVars);
 }
 
 void MaxSATParserProlog::parseDetach() {
@@ -57,7 +85,7 @@ void MaxSATParserClause::parse() {
     int64_t weight = 1;
     if(parserProlog.isWeighted()) weight = parseLong(in());
     Glucose::readClause(in(), parserProlog.getSolver(), lits);
-    if(weight == parserProlog.getTop()) parserProlog.getSolver().addClause_(lits);
+    if(weight == parserProlog.getTop()) parserProlog.getSolver().addHardClause(lits);
     else parserProlog.getSolver().addWeightedClause(lits, weight);
 }
 
@@ -67,14 +95,75 @@ void MaxSATParserClause::parseDetach() {
     lits.moveTo(tmp);
 }
 
-MaxSAT::MaxSAT() : parserProlog(*this), parserClause(parserProlog), ccPropagator(*this), lowerBound(0), upperBound(INT64_MAX) {
+struct MaxSAT::Portfolio {
+    std::mutex mutex;
+    int64_t lowerBound;
+    int64_t upperBound;
+    vec<lbool> model;
+    // soft literals hardened by some engine; only literals over the first nVars variables are shared, as they are known to all engines
+    int nVars;
+    vec<Lit> hardened;
+    vec<MaxSAT*> engines;
+    bool closed;
+};
+
+MaxSAT::MaxSAT() : parserProlog(*this), parserClause(parserProlog), ccPropagator(*this, option_maxsat_watched_cc, option_restore_on_cancel), wcPropagator(*this, &ccPropagator, option_restore_on_cancel), stratification(option_maxsat_strat), usePreferences(option_maxsat_use_preferences), minShrinkBudget(1000), lowerBound(0), upperBound(INT64_MAX), portfolio(NULL), nImportedHardened(0), localSearch(NULL) {
+    setPropagators(ccPropagator, wcPropagator);
+    if(option_maxsat_local_search && !option_maxsat_top_k && option_maxsat_portfolio == 1) localSearch = new LocalSearch(random_seed);
+    if(option_maxsat_shrink_threads > 1) shrinkPool = new ThreadPool(option_maxsat_shrink_threads - 1);
     setParser('p', &parserProlog);
     setParser(&parserClause);
     setModelsStart("");
 }
 
+MaxSAT::MaxSAT(const MaxSAT& init) : StaticGlucoseWrapper<CardinalityConstraintPropagator, WeightConstraintPropagator>(init), parserProlog(*this), parserClause(parserProlog), ccPropagator(*this, init.ccPropagator), wcPropagator(*this, init.wcPropagator, &ccPropagator), stratification(init.stratification), usePreferences(init.usePreferences), minShrinkBudget(init.minShrinkBudget), softLits(init.softLits), weights(init.weights), weightIndex(init.weightIndex), lazyConstraints(init.lazyConstraints), lazyConstraintOf(init.lazyConstraintOf), delayedConflicts(init.delayedConflicts), nInputVars(init.nInputVars), lowerBound(init.lowerBound), upperBound(init.upperBound), conflicts_bkp(init.conflicts_bkp), portfolio(NULL), nImportedHardened(0), localSearch(NULL) {
+    setPropagators(ccPropagator, wcPropagator);
+}
+
+MaxSAT::~MaxSAT() {
+    delete localSearch;
+    delete shrinkPool;
+    lockEngines();
+    for(int i = 0; i < shrinkEngines.size(); i++) delete shrinkEngines[i];
+    shrinkEngines.clear();
+    enginesLocked = false;
+}
+
 void MaxSAT::interrupt() {
     GlucoseWrapper::interrupt();
+    interruptEngines();
+    if(localSearch != NULL) {
+        // solve() prints the best model once local search is stopped
+        localSearch->interrupt();
+        return;
+    }
+    if(portfolio != NULL) {
+        // the handler cannot wait for the mutex: solvePortfolio() prints the best model once all engines are stopped
+        for(int i = 0; i < portfolio->engines.size(); i++) portfolio->engines[i]->GlucoseWrapper::interrupt();
+        return;
+    }
+    onInterrupt();
+}
+
+// Invoked by the signal handler, possibly while the engines are replaced in another thread: they are skipped in this case,
+// and the thread replacing them interrupts them in unlockEngines().
+void MaxSAT::interruptEngines() {
+    if(enginesLocked.exchange(true)) return;
+    for(int i = 0; i < shrinkEngines.size(); i++) shrinkEngines[i]->GlucoseWrapper::interrupt();
+    for(int i = 0; i < disjointCoreEngines.size(); i++) disjointCoreEngines[i]->GlucoseWrapper::interrupt();
+    enginesLocked = false;
+}
+
+void MaxSAT::lockEngines() {
+    while(enginesLocked.exchange(true)) std::this_thread::yield();
+}
+
+void MaxSAT::unlockEngines() {
+    enginesLocked = false;
+    if(interrupted()) interruptEngines();
+}
+
+void MaxSAT::onInterrupt() {
     if(!option_maxsat_top_k && upperBound != INT64_MAX) {
         cout << "o " << upperBound << endl;
         onModel();
@@ -85,6 +174,7 @@ void MaxSAT::interrupt() {
 
 Var MaxSAT::newVar(bool polarity, bool dvar) {
     weights.push(0);
+    lazyConstraintOf.push(-1);
     return GlucoseWrapper::newVar(polarity, dvar);
 }
 
@@ -93,8 +183,14 @@ void MaxSAT::parse(gzFile in) {
     for(int i = 0; i < softLits.size(); i++) setFrozen(var(softLits[i]), true);
 }
 
+void MaxSAT::addHardClause(vec<Lit>& lits) {
+    if(localSearch != NULL) localSearch->addClause(lits, 0);
+    addClause_(lits);
+}
+
 void MaxSAT::addWeightedClause(vec<Lit>& lits, int64_t weight) {
     if(weight == 0) return;
+    if(localSearch != NULL) localSearch->addClause(lits, weight);
 
     Lit soft;
     if(lits.size() == 1)
@@ -113,7 +209,7 @@ void MaxSAT::addWeightedClause(vec<Lit>& lits, int64_t weight) {
 
     assert(weights.size() == nVars());
     if(weights[var(soft)] == 0) {
-        weights[var(soft)] = weight;
+        setWeight(var(soft), weight);
         softLits.push(soft);
         return;
     }
@@ -122,51 +218,92 @@ void MaxSAT::addWeightedClause(vec<Lit>& lits, int64_t weight) {
     for(; pos < softLits.size(); pos++) if(var(softLits[pos]) == var(soft)) break;
     assert(pos < softLits.size());
 
-    if(softLits[pos] == soft) weights[var(soft)] += weight;
+    if(softLits[pos] == soft) setWeight(var(soft), weights[var(soft)] + weight);
     else if(weights[var(soft)] == weight) {
         addToLowerBound(weight);
-        weights[var(soft)] = 0;
+        setWeight(var(soft), 0);
         softLits[pos] = softLits[softLits.size()-1];
         softLits.shrink_(1);
     }
     else if(weights[var(soft)] < weight) {
         addToLowerBound(weights[var(soft)]);
         softLits[pos] = soft;
-        weights[var(soft)] = weight - weights[var(soft)];
+        setWeight(var(soft), weight - weights[var(soft)]);
     }
     else {
         assert(weights[var(soft)] > weight);
         addToLowerBound(weight);
-        weights[var(soft)] -= weight;
+        setWeight(var(soft), weights[var(soft)] - weight);
     }
 }
 
 void MaxSAT::addToLowerBound(int64_t value) {
     assert(value > 0);
     lowerBound += value;
+    if(portfolio == NULL) { printLowerBound(); return; }
+
+    std::lock_guard<std::mutex> lock(portfolio->mutex);
+    if(lowerBound <= portfolio->lowerBound) return;
+    portfolio->lowerBound = lowerBound;
     printLowerBound();
+    if(portfolio->lowerBound == portfolio->upperBound) closePortfolio();
 }
 
-void MaxSAT::updateUpperBound() {
+int64_t MaxSAT::computeModelCost() const {
     int64_t sum = lowerBound;
     for(int i = 0; i < softLits.size(); i++) if(value(softLits[i]) == l_False) sum += weights[var(softLits[i])];
-    if(sum < upperBound) {
-        upperBound = sum;
-        copyModel();
-        printUpperBound();
+    // a delayed core is already in the lower bound once, while its relaxation would count each violated soft literal but one
+    for(int i = 0; i < delayedConflicts.size(); i++) {
+        int violated = 0;
+        for(int j = 0; j < delayedConflicts[i].lits.size(); j++) if(value(delayedConflicts[i].lits[j]) == l_True) violated++;
+        assert(violated > 0);
+        sum += (violated - 1) * delayedConflicts[i].weight;
     }
+    return sum;
+}
+
+// the cost is not exact if the last output of a lazy constraint is false, as missing outputs do not count violated literals
+bool MaxSAT::hasExactCost() const {
+    for(int i = 0; i < lazyConstraints.size(); i++) if(lazyConstraints[i].outputs < lazyConstraints[i].bound && value(lazyConstraints[i].last) == l_False) return false;
+    return true;
+}
+
+void MaxSAT::updateUpperBound() {
+    if(!hasExactCost()) { trace(maxsat, 8, "Skip model of inexact cost"); return; }
+    int64_t sum = computeModelCost();
+    if(sum >= upperBound) return;
+    upperBound = sum;
+    copyModel();
+    publishUpperBound();
+}
+
+void MaxSAT::publishUpperBound() {
+    if(portfolio == NULL) { printUpperBound(); return; }
+
+    std::lock_guard<std::mutex> lock(portfolio->mutex);
+    if(upperBound >= portfolio->upperBound) return;
+    portfolio->upperBound = upperBound;
+    model.copyTo(portfolio->model);
+    printUpperBound();
+    if(portfolio->lowerBound == portfolio->upperBound) closePortfolio();
 }
 
 void MaxSAT::hardening() {
     assert(!option_maxsat_top_k);
     cancelUntil(0);
+    if(portfolio != NULL) syncPortfolio();
+    if(localSearch != NULL) syncLocalSearch();
     int j = 0;
     for(int i = 0; i < softLits.size(); i++) {
         int64_t diff = weights[var(softLits[i])] + lowerBound - upperBound;
         if(option_n == 1 ? diff >= 0 : diff > 0) {
             addClause(softLits[i]);
             trace(maxsat, 30, "Hardening of " << softLits[i] << " of weight " << weights[var(softLits[i])]);
-            weights[var(softLits[i])] = 0;
+            if(portfolio != NULL && var(softLits[i]) < portfolio->nVars) {
+                std::lock_guard<std::mutex> lock(portfolio->mutex);
+                portfolio->hardened.push(softLits[i]);
+            }
+            setWeight(var(softLits[i]), 0);
             continue;
         }
         softLits[j++] = softLits[i];
@@ -174,14 +311,40 @@ void MaxSAT::hardening() {
     softLits.shrink_(softLits.size()-j);
 }
 
-int64_t MaxSAT::computeNextLimit(int64_t limit) const {
-    int64_t next = limit;
-    for(int i = 0; i < softLits.size(); i++) {
-        int64_t w = weights[var(softLits[i])];
-        if(w == 0) continue;
-        if(w >= limit) continue;
-        if(next == limit || w > next) next = w;
+void MaxSAT::setWeight(Var v, int64_t weight) {
+    assert(weight >= 0);
+    if(weights[v] != 0) {
+        std::map<int64_t, int>::iterator it = weightIndex.find(weights[v]);
+        assert(it != weightIndex.end());
+        if(--it->second == 0) weightIndex.erase(it);
     }
+    weights[v] = weight;
+    if(weight != 0) weightIndex[weight]++;
+}
+
+int64_t MaxSAT::computeNextLimit(int64_t limit) {
+    if(stratification == 0) return 1;
+    if(limit == INT64_MAX) strata = 0;
+
+    std::map<int64_t, int>::const_iterator it = weightIndex.lower_bound(limit);
+    if(it == weightIndex.begin()) return limit;
+    --it;
+
+    int64_t next = it->first;
+    if(stratification == 2) {
+        // merge the next weights until the level has enough soft literals per distinct weight
+        int count = 0;
+        for(int distinct = 1; ; distinct++, --it) {
+            count += it->second;
+            next = it->first;
+            if(count >= option_maxsat_strat_ratio * distinct || it == weightIndex.begin()) break;
+        }
+    }
+    else if(stratification == 3) next = weightIndex.lower_bound(static_cast<int64_t>(ceil(next / option_maxsat_strat_ratio)))->first;
+
+    strata++;
+    trace(maxsat, 8, "Stratification level " << strata << ": limit " << next);
+    if(option_maxsat_strat_max > 0 && strata >= option_maxsat_strat_max) return 1;
     return next;
 }
 
@@ -211,6 +374,7 @@ void MaxSAT::trimConflict() {
         assumptions.clear();
         for(int i = 0; i < conflict.size(); i++) assumptions.push(~conflict[i]);
         status = solveWithBudget();
+        if(status == l_Undef) { assert(interrupted()); return; }
         assert(status == l_False);
         trace(maxsat, 15, "Trim " << assumptions.size() - conflict.size() << " literals from conflict");
         trace(maxsat, 100, "Conflict: " << conflict);
@@ -229,7 +393,11 @@ void MaxSAT::shrinkConflict(int64_t limit) {
     if(conflict.size() <= 1) return;
 
     trimConflict();
+    if(shrinkPool == NULL) shrinkTrimmedConflict(limit);
+    else parallelShrinkConflict(limit);
+}
 
+void MaxSAT::shrinkTrimmedConflict(int64_t limit) {
     vec<Lit> core;
     conflict.moveTo(core);
 
@@ -237,14 +405,13 @@ void MaxSAT::shrinkConflict(int64_t limit) {
     for(int i = 0; i < core.size(); i++) allAssumptions.push(~core[i]);
 
     uint64_t budget = conflicts - conflicts_bkp;
-    const uint64_t min_budget = 1000;
-    if(budget < min_budget) budget = min_budget;
+    if(budget < minShrinkBudget) budget = minShrinkBudget;
 
     assumptions.clear();
     const int progressionFrom = 1;
     int progression = progressionFrom;
     int fixed = 0;
-    while(lowerBound + limit < upperBound) {
+    while(lowerBound + limit < upperBound && !interrupted()) {
         if(fixed + progression >= allAssumptions.size()) {
             if(progression == progressionFrom) break;
             progression = progressionFrom;
@@ -302,6 +469,75 @@ void MaxSAT::shrinkConflict(int64_t limit) {
     core.moveTo(conflict);
 }
 
+// Each engine of shrinkEngines shrinks a shuffled copy of the core while this engine shrinks the original one, and the smallest result is kept.
+// Engines are copies of this engine, possibly missing some clause added later: their cores are cores of this engine as well, but the core of this engine
+// may be satisfiable for them. In that case, or if the core contains variables they do not know, they are copied again.
+void MaxSAT::parallelShrinkConflict(int64_t limit) {
+    assert(decisionLevel() == 0);
+    parallelShrinks++;
+
+    Var maxVar = 0;
+    for(int i = 0; i < conflict.size(); i++) if(var(conflict[i]) > maxVar) maxVar = var(conflict[i]);
+    uint64_t budget = conflicts - conflicts_bkp;
+
+    std::vector<char> valid(shrinkPool->size(), false);
+    for(int i = 0; i < shrinkPool->size(); i++) {
+        if(i == shrinkEngines.size() || shrinkEngines[i]->nVars() <= maxVar) copyShrinkEngine(i);
+        MaxSAT* engine = shrinkEngines[i];
+        engine->lowerBound = lowerBound;
+        engine->upperBound = upperBound;
+        engine->minShrinkBudget = budget > minShrinkBudget ? budget : minShrinkBudget;
+        engine->conflicts_bkp = engine->conflicts;
+        conflict.copyTo(engine->conflict);
+        for(int j = engine->conflict.size() - 1; j > 0; j--) {
+            int k = shrinkRandom() % (j + 1);
+            Lit tmp = engine->conflict[j];
+            engine->conflict[j] = engine->conflict[k];
+            engine->conflict[k] = tmp;
+        }
+        char* result = &valid[i];
+        shrinkPool->run([engine, limit, result]() { *result = engine->shrinkCopiedConflict(limit); });
+    }
+    shrinkTrimmedConflict(limit);
+    shrinkPool->wait();
+
+    for(int i = 0; i < shrinkEngines.size(); i++) {
+        if(!valid[i]) {
+            if(!interrupted()) copyShrinkEngine(i);
+            continue;
+        }
+        if(shrinkEngines[i]->conflict.size() >= conflict.size()) continue;
+        trace(maxsat, 10, "Shrink: engine " << i + 1 << " reduced to size " << shrinkEngines[i]->conflict.size());
+        shrinkEngines[i]->conflict.copyTo(conflict);
+        parallelShrinkImprovements++;
+    }
+}
+
+void MaxSAT::copyShrinkEngine(int index) {
+    assert(decisionLevel() == 0);
+    shrinkEngineCopies++;
+    MaxSAT* engine = new MaxSAT(*this);
+    engine->setId("shrink " + std::to_string(index + 1));
+    lockEngines();
+    if(index == shrinkEngines.size()) shrinkEngines.push(engine);
+    else { delete shrinkEngines[index]; shrinkEngines[index] = engine; }
+    unlockEngines();
+}
+
+// false if the engine misses the clauses making the core unsatisfiable (or cannot prove it within the budget)
+bool MaxSAT::shrinkCopiedConflict(int64_t limit) {
+    assumptions.clear();
+    for(int i = 0; i < conflict.size(); i++) assumptions.push(~conflict[i]);
+    setConfBudget(minShrinkBudget);
+    lbool status = solveWithBudget();
+    budgetOff();
+    cancelUntil(0);
+    if(status != l_False) return false;
+    shrinkTrimmedConflict(limit);
+    trimConflict();
+    return true;
+}
+
 int64_t MaxSAT::computeConflictWeight() const {
     int64_t min = INT64_MAX;
     for(int i = 0; i < conflict.size(); i++) if(weights[var(conflict[i])] < min) min = weights[var(conflict[i])];
@@ -332,6 +568,41 @@ int64_t MaxSAT::computeConflictWeight() const {
 //    ccPropagator.addGreaterEqual(lits, bound);
 //}
 void MaxSAT::processConflict(int64_t weight) {
+    reduceWeights(weight);
+    relaxConflict(weight);
+}
+
+void MaxSAT::reduceWeights(int64_t weight) {
+    assert(decisionLevel() == 0);
+    // the next output of a lazy constraint is needed when its last output is relaxed
+    for(int i = 0; i < conflict.size(); i++) if(lazyConstraintOf[var(conflict[i])] != -1) addLazyOutput(lazyConstraintOf[var(conflict[i])], true);
+    for(int i = 0; i < conflict.size(); i++) setWeight(var(conflict[i]), weights[var(conflict[i])] - weight);
+}
+
+// The soft literals of the core are not assumed anymore if their weight is now zero, so that more disjoint cores can be found before relaxing them.
+void MaxSAT::delayConflict(int64_t weight) {
+    reduceWeights(weight);
+    trace(maxsat, 10, "Delay relaxation of conflict of size " << conflict.size());
+    delayedConflicts.push();
+    delayedConflicts.last().weight = weight;
+    conflict.moveTo(delayedConflicts.last().lits);
+}
+
+void MaxSAT::relaxDelayedConflicts() {
+    cancelUntil(0);
+    trace(maxsat, 4, "Relax " << delayedConflicts.size() << " delayed conflicts");
+    relaxationBatches++;
+    // relaxing each core as soon as it is found would take one more call of the solver per core but the last
+    if(delayedConflicts.size() > 0) savedSolverCalls += delayedConflicts.size() - 1;
+    for(int i = 0; i < delayedConflicts.size(); i++) {
+        delayedConflicts[i].lits.moveTo(conflict);
+        relaxConflict(delayedConflicts[i].weight);
+        relaxedDelayedConflicts++;
+    }
+    delayedConflicts.clear();
+}
+
+void MaxSAT::relaxConflict(int64_t weight) {
     assert(decisionLevel() == 0);
     trace(maxsat, 10, "Use algorithm kdyn");
 
@@ -357,7 +628,6 @@ void MaxSAT::processConflict(int64_t weight) {
         if(prec != lit_Undef) { lits.push(prec); i--; }
         for(; i > 0; i--) {
             if(conflict.size() == 0) break;
-            weights[var(conflict.last())] -= weight;
             lits.push(~conflict.last());
             conflict.pop();
         }
@@ -366,19 +636,31 @@ void MaxSAT::processConflict(int64_t weight) {
 
         if(conflict.size() > 0) bound++;
 
+        if(option_maxsat_lazy_outputs && bound >= 2) {
+            trace(maxsat, 25, "Add lazy constraint of size " << lits.size());
+            lazyConstraints.push();
+            LazyConstraint& c = lazyConstraints.last();
+            lits.moveTo(c.lits);
+            c.bound = bound;
+            c.outputs = 0;
+            c.last = lit_Undef;
+            c.weight = weight;
+            if(conflict.size() > 0) prec = addLazyOutput(lazyConstraints.size()-1, false);
+            addLazyOutput(lazyConstraints.size()-1, true);
+            if(conflict.size() == 0) break;
+            continue;
+        }
+
         for(i = 0; i < bound; i++) {
             newVar();
-            if(option_maxsat_use_preferences) preference[nVars()-1] = true;
+            if(usePreferences) preference[nVars()-1] = true;
             insertVarOrder(nVars()-1);
             setFrozen(nVars()-1, true);
             lits.push(~mkLit(nVars()-1));
             if(i != 0) addClause(~mkLit(nVars()-2), mkLit(nVars()-1)); // symmetry breaker
-            if(i == 0 && conflict.size() > 0) {
-                weights.last() = 0;
-                prec = mkLit(nVars()-1);
-            }
+            if(i == 0 && conflict.size() > 0) prec = mkLit(nVars()-1);
             else {
-                weights.last() = weight;
+                setWeight(nVars()-1, weight);
                 softLits.push(mkLit(nVars()-1));
             }
         }
@@ -392,17 +674,61 @@ void MaxSAT::processConflict(int64_t weight) {
     assert(conflict.size() == 0);
 }
 
+// The outputs of the constraint are only those created so far, while the ones still missing are left free.
+// The cost of a model is exact if the last output is true, as it bounds the violated literals. This is the case when the last output is assumed,
+// while models found without assuming it, as at levels above its weight, are checked by hasExactCost().
+Lit MaxSAT::addLazyOutput(int constraint, bool soft) {
+    newVar();
+    Var v = nVars()-1;
+    if(usePreferences) preference[v] = true;
+    insertVarOrder(v);
+    setFrozen(v, true);
+
+    LazyConstraint& c = lazyConstraints[constraint];
+    assert(c.outputs < c.bound);
+    if(c.last != lit_Undef) {
+        addClause(~c.last, mkLit(v)); // symmetry breaker
+        lazyConstraintOf[var(c.last)] = -1;
+    }
+    c.last = mkLit(v);
+    c.outputs++;
+
+    vec<Lit> lits;
+    vec<int64_t> ws;
+    c.lits.copyTo(lits);
+    ws.growTo(lits.size(), 1);
+    int64_t bound = c.bound - c.outputs + 1;
+    lits.push(~mkLit(v));
+    ws.push(bound);
+    trace(maxsat, 25, "Add output " << c.outputs << " of " << c.bound << " to lazy constraint " << constraint);
+    wcPropagator.addGreaterEqual(lits, ws, bound);
+
+    if(soft) {
+        setWeight(v, c.weight);
+        softLits.push(mkLit(v));
+        if(c.outputs < c.bound) lazyConstraintOf[v] = constraint;
+    }
+    return mkLit(v);
+}
+
 void MaxSAT::preprocess() {
     assert(decisionLevel() == 0);
     if(softLits.size() == 0) return;
     trace(maxsat, 10, "Preprocessing");
 
+    findInputCores();
+    // cores of all levels are relaxed before the main loop starts again from the first level, where the outputs of cores of lower levels are not assumed:
+    // lazy constraints and delayed cores expect them to be assumed, so that models have exact costs and relaxed cores are processed at the same level
+    if(option_maxsat_disjoint_cores > 0 && !option_maxsat_lazy_outputs && !option_maxsat_wce) findDisjointCores(option_maxsat_disjoint_cores);
+}
+
+void MaxSAT::findInputCores() {
     trace(maxsat, 20, "Preprocessing: cache signs of soft literals");
     vec<bool> signs;
     signs.growTo(nVars());
     for(int i = 0; i < softLits.size(); i++) {
         if(weights[var(softLits[i])] != weights[var(softLits[0])]) {
-            trace(maxsat, 10, "Preprocessing: detected weighted instance; skip preprocessing");
+            trace(maxsat, 10, "Preprocessing: detected weighted instance; skip search for input clauses being cores");
             return;
         }
         signs[var(softLits[i])] = sign(softLits[i]);
@@ -453,6 +779,98 @@ void MaxSAT::preprocess() {
     for(int i = 0; i < clausesPartition.size(); i++) delete clausesPartition[i];
 }
 
+// Cores are searched by this engine and by copies of it running in parallel, with calls of small budget assuming the soft literals of a stratification level
+// that are not in the cores found so far. Each engine first assumes its share of these literals, so that engines do not find the same cores, and then all of them.
+// Cores are disjoint, hence all of them are relaxed: their weights raise the lower bound, and the stratified search starts from the residual weights.
+void MaxSAT::findDisjointCores(int threads) {
+    assert(decisionLevel() == 0);
+    trace(maxsat, 20, "Preprocessing: search for disjoint cores with " << threads << " threads");
+
+    vec<int64_t> limits;
+    for(int64_t limit = computeNextLimit(INT64_MAX);;) {
+        limits.push(limit);
+        int64_t next = computeNextLimit(limit);
+        if(next == limit) break;
+        limit = next;
+    }
+
+    DisjointCores shared;
+    shared.used.growTo(nVars(), false);
+    lockEngines();
+    disjointCoreEngines.push(this);
+    for(int i = 1; i < threads; i++) {
+        MaxSAT* engine = new MaxSAT(*this);
+        engine->setId("cores " + std::to_string(i));
+        disjointCoreEngines.push(engine);
+    }
+    unlockEngines();
+    {
+        ThreadPool pool(threads - 1);
+        for(int i = 1; i < threads; i++) {
+            MaxSAT* engine = disjointCoreEngines[i];
+            pool.run([engine, i, threads, &limits, &shared]() { engine->searchDisjointCores(limits, i, threads, shared); });
+        }
+        searchDisjointCores(limits, 0, threads, shared);
+        pool.wait();
+    }
+    lockEngines();
+    for(int i = 1; i < disjointCoreEngines.size(); i++) delete disjointCoreEngines[i];
+    disjointCoreEngines.clear();
+    unlockEngines();
+    cancelUntil(0);
+    if(interrupted()) return;
+
+    int64_t weight = 0;
+    for(int i = 0; i < shared.cores.size(); i++) {
+        shared.cores[i].moveTo(conflict);
+        int64_t w = computeConflictWeight();
+        weight += w;
+        addToLowerBound(w);
+        trace(maxsat, 4, "Analyze conflict of size " << conflict.size() << " and weight " << w);
+        processConflict(w);
+    }
+    statistics(print_statistics(maxsat, "disjoint cores: " << shared.cores.size() << " of weight " << weight));
+}
+
+// run by the engines of findDisjointCores, where index identifies the share of soft literals
+void MaxSAT::searchDisjointCores(const vec<int64_t>& limits, int index, int engines, DisjointCores& shared) {
+    for(int l = 0; l < limits.size(); l++) {
+        for(int round = 0; round < 2; round++) {
+            for(;;) {
+                if(interrupted()) return;
+                cancelUntil(0);
+                assumptions.clear();
+                {
+                    std::lock_guard<std::mutex> lock(shared.mutex);
+                    for(int i = 0; i < softLits.size(); i++) {
+                        if(weights[var(softLits[i])] < limits[l] || shared.used[var(softLits[i])]) continue;
+                        if(round == 0 && i % engines != index) continue;
+                        assumptions.push(softLits[i]);
+                    }
+                }
+                if(assumptions.size() == 0) break;
+
+                setConfBudget(DISJOINT_CORES_BUDGET);
+                lbool status = solveWithBudget();
+                budgetOff();
+                if(status != l_False) break;
+                // the hard clauses are inconsistent, and the main loop will find it out
+                if(conflict.size() == 0) return;
+                trimConflict();
+
+                std::lock_guard<std::mutex> lock(shared.mutex);
+                int i = 0;
+                for(; i < conflict.size(); i++) if(shared.used[var(conflict[i])]) break;
+                if(i < conflict.size()) continue;
+                trace(maxsat, 10, "Preprocessing: disjoint core of size " << conflict.size());
+                for(i = 0; i < conflict.size(); i++) shared.used[var(conflict[i])] = true;
+                shared.cores.push();
+                conflict.copyTo(shared.cores.last());
+            }
+        }
+    }
+}
+
 void MaxSAT::sortSoftByWeight() {
     vec<vec<Lit>*> softPartition;
     vec<int> sizes;
@@ -573,19 +991,39 @@ lbool MaxSAT::solve_top_k() {
 
     lbool status;
 
+    // Blocking clauses only remove models, so cores and their relaxation remain valid, and the next models cost at least lowerBound.
+    // Models found while searching one of the k solutions are kept as candidates for the next ones: the best candidate is the initial upper bound,
+    // and it is the next solution as soon as lowerBound reaches its cost. A model of cost lowerBound satisfies all soft literals, and is searched
+    // before the stratified search restarts.
+    vec<TopKCandidate> candidates;
     for(int model_count = 0;;) {
+        int64_t candidateCost = INT64_MAX;
+        if(model_count > 0) {
+            if(candidates.size() > 0) {
+                candidateCost = upperBound = candidates[0].cost;
+                candidates[0].model.copyTo(model);
+            }
+            if(lowerBound < upperBound) {
+                setAssumptions(1);
+                solverCalls++;
+                status = solveWithBudget();
+                if(status == l_Undef) return l_Undef;
+                if(status == l_True) { addTopKCandidate(candidates, originalSoftLits, option_n - model_count); updateUpperBound(); }
+                else if(conflict.size() == 0) lowerBound = upperBound;
+            }
+        }
         int64_t limit = computeNextLimit(INT64_MAX);
-        int64_t last_limit_with_model = INT64_MAX;
         for (;;) {
             if (interrupted()) return l_Undef;
 
             setAssumptions(limit);
             if (lowerBound == upperBound) break;
             conflicts_bkp = conflicts;
+            solverCalls++;
             status = solveWithBudget();
             if (status == l_True) {
+                addTopKCandidate(candidates, originalSoftLits, option_n - model_count);
                 updateUpperBound();
-                last_limit_with_model = limit;
                 limit = computeNextLimit(limit);
             } else {
                 assert(status == l_False);
@@ -598,7 +1036,7 @@ lbool MaxSAT::solve_top_k() {
                     continue;
                 }
 
-                assert_msg(computeConflictWeight() == limit,
+                assert_msg(stratification != 1 || option_maxsat_strat_max != 0 || computeConflictWeight() == limit,
                            "computeConflictWeight()=" << computeConflictWeight() << "; limit=" << limit << "; conflict="
                                                       << conflict);
                 shrinkConflict(limit);
@@ -606,7 +1044,7 @@ lbool MaxSAT::solve_top_k() {
                 assert(decisionLevel() == 0);
 
                 int64_t w = computeConflictWeight();
-                assert(w == limit);
+                assert(stratification != 1 || option_maxsat_strat_max != 0 || w == limit);
                 addToLowerBound(w);
 
                 assert(conflict.size() > 0);
@@ -615,11 +1053,13 @@ lbool MaxSAT::solve_top_k() {
             }
         }
         assert(lowerBound == upperBound);
+        if(upperBound == candidateCost) topKCandidatesUsed++;
 
         if(upperBound == INT64_MAX) {
             cout << 'v' << endl;    // no more solutions
+            statistics(print_statistics(maxsat, "solver calls: " << solverCalls << "; models: " << model_count << "; candidates used: " << topKCandidatesUsed));
             onDoneIteration();
-            return model == 0 ? l_False : l_True;
+            return model_count == 0 ? l_False : l_True;
         }
 
         model_count++;
@@ -638,13 +1078,60 @@ lbool MaxSAT::solve_top_k() {
         cancelUntil(0);
         addClause(blocking_clause);
 
+        // the printed model is blocked, and so are the candidates with the same soft literals
+        int j = 0;
+        for(int i = 0; i < candidates.size(); i++) {
+            int k = 0;
+            for(; k < originalSoftLits.size(); k++) if(candidates[i].model[var(originalSoftLits[k])] != modelValue(var(originalSoftLits[k]))) break;
+            if(k == originalSoftLits.size()) continue;
+            if(i != j) candidates[i].model.moveTo(candidates[j].model);
+            candidates[j++].cost = candidates[i].cost;
+        }
+        candidates.shrink_(candidates.size() - j);
+
         upperBound = INT64_MAX;
     }
 
+    statistics(print_statistics(maxsat, "solver calls: " << solverCalls << "; models: " << option_n << "; candidates used: " << topKCandidatesUsed));
     onDoneIteration();
     return l_True;
 }
 
+// candidates are sorted by cost, and have distinct values of the soft literals; only the best max of them are kept (all if max is not positive)
+void MaxSAT::addTopKCandidate(vec<TopKCandidate>& candidates, const vec<Lit>& originalSoftLits, int max) {
+    if(!hasExactCost()) return;
+    int64_t cost = computeModelCost();
+    if(max > 0 && candidates.size() >= max && cost >= candidates.last().cost) return;
+    for(int i = 0; i < candidates.size(); i++) {
+        int k = 0;
+        for(; k < originalSoftLits.size(); k++) if(candidates[i].model[var(originalSoftLits[k])] != value(var(originalSoftLits[k]))) break;
+        if(k < originalSoftLits.size()) continue;
+        if(candidates[i].cost <= cost) return;
+        // the same solution has a smaller cost in the current relaxation
+        for(int j = i + 1; j < candidates.size(); j++) {
+            candidates[j].model.moveTo(candidates[j-1].model);
+            candidates[j-1].cost = candidates[j].cost;
+        }
+        candidates.pop();
+        break;
+    }
+    if(max > 0 && candidates.size() >= max) candidates.pop();
+
+    int i = candidates.size();
+    candidates.push();
+    for(; i > 0 && candidates[i-1].cost > cost; i--) {
+        candidates[i-1].model.moveTo(candidates[i].model);
+        candidates[i].cost = candidates[i-1].cost;
+    }
+    candidates[i].cost = cost;
+    // eliminated variables are assigned by copyModel(), which is applied without losing the model of the upper bound
+    vec<lbool> best;
+    model.moveTo(best);
+    copyModel();
+    model.moveTo(candidates[i].model);
+    best.moveTo(model);
+}
+
 lbool MaxSAT::solve() {
     if(option_maxsat_top_k) return solve_top_k();
 
@@ -652,60 +1139,430 @@ lbool MaxSAT::solve() {
 
     preprocess();
 
+    if(localSearch != NULL) localSearch->start();
+    lbool status;
+    if(option_maxsat_portfolio > 1 && option_n == 1) status = solvePortfolio();
+    else if(option_maxsat_ihs && option_n == 1) status = solveImplicitHittingSet();
+    else status = optimize();
+    if(localSearch != NULL) {
+        localSearch->stop();
+        statistics(print_statistics(maxsat, "local search: " << localSearch->getFlips() << " flips; " << localSearch->getImprovements() << " improvements"));
+        if(status == l_Undef) { syncLocalSearch(); onInterrupt(); }
+    }
+    statistics(if(shrinkPool != NULL) print_statistics(maxsat, "parallel shrink: " << parallelShrinks << " cores; " << parallelShrinkImprovements << " improved by other orders; " << shrinkEngineCopies << " copies of engines"));
+    if(status == l_Undef) return l_Undef;
+    assert(lowerBound == upperBound);
+
+    if(upperBound == INT64_MAX) { onDoneIteration(); return l_False; }
+
+    printLowerBound();
+    if(option_maxsat_wce) printSavedSolverCalls();
+    printOptimum();
+    if(option_n == 1) onModel();
+    else enumerateModels();
+    statistics(print_statistics(maxsat, "solver calls: " << solverCalls << "; models of linear search: " << linearSearchModels << "; improvements of lns: " << lnsImprovements << "; stratification levels: " << strata << "; delayed conflicts: " << relaxedDelayedConflicts << " relaxed in " << relaxationBatches << " batches, " << savedSolverCalls << " solver calls saved"));
+    onDoneIteration();
+    return l_True;
+}
+
+lbool MaxSAT::optimize() {
     lbool status;
 //    = solveWithBudget();
 //    if(status == l_False) { printUnsat(); return l_False; }
 //    if(status == l_True) updateUpperBound();
 //    hardening();
 
+    if(option_maxsat_linear_search > 0 && option_n == 1) linearSearch();
+
     int64_t limit = computeNextLimit(INT64_MAX);
     for(;;) {
         if(interrupted()) return l_Undef;
 
         hardening();
         setAssumptions(limit);
-        if(lowerBound == upperBound) break;
+        if(lowerBound == upperBound) {
+            // models to enumerate must satisfy the relaxation of all cores
+            if(delayedConflicts.size() == 0) break;
+            relaxDelayedConflicts();
+            continue;
+        }
         conflicts_bkp = conflicts;
+        solverCalls++;
         status = solveWithBudget();
         if(status == l_True) {
+            int64_t ub = upperBound;
             updateUpperBound();
-            limit = computeNextLimit(limit);
+            if(option_maxsat_lns > 0 && option_n == 1 && upperBound < ub) lns();
+            // the outputs of the relaxed cores are assumed at the same limit
+            if(delayedConflicts.size() > 0) relaxDelayedConflicts();
+            else {
+                limit = computeNextLimit(limit);
+                if(option_maxsat_linear_search > 0 && option_n == 1 && conflicts >= nextLinearSearch) linearSearch();
+            }
         }
-        else {
-            assert(status == l_False);
+        else if(status == l_False) {
             trace(maxsat, 2, "UNSAT! Conflict of size " << conflict.size());
             trace(maxsat, 100, "Conflict: " << conflict);
 
             if(conflict.size() == 0) { lowerBound = upperBound; limit = 1; continue; }
 
-            assert_msg(computeConflictWeight() == limit, "computeConflictWeight()=" << computeConflictWeight() << "; limit=" << limit << "; conflict=" << conflict);
+            // levels grouping several weights and soft literals hardened by other engines of a portfolio may produce cores of literals above the limit
+            assert_msg(stratification != 1 || option_maxsat_strat_max != 0 || portfolio != NULL || computeConflictWeight() == limit, "computeConflictWeight()=" << computeConflictWeight() << "; limit=" << limit << "; conflict=" << conflict);
             shrinkConflict(limit);
             trimConflict(); // last trim, just in case some new learned clause may help to further reduce the core
             assert(decisionLevel() == 0);
+            if(interrupted()) return l_Undef;
 
             int64_t w = computeConflictWeight();
-            assert(w == limit);
+            assert(stratification != 1 || option_maxsat_strat_max != 0 || portfolio != NULL || w == limit);
             addToLowerBound(w);
 
             assert(conflict.size() > 0);
             trace(maxsat, 4, "Analyze conflict of size " << conflict.size() << " and weight " << w);
-            processConflict(w);
+            if(option_maxsat_wce) delayConflict(w);
+            else processConflict(w);
         }
+        else assert(interrupted());
     }
     assert(lowerBound == upperBound);
+    assert(softLits.size() == 0);
 
-    if(upperBound == INT64_MAX) { onDoneIteration(); return l_False; }
+    if(portfolio != NULL) {
+        std::lock_guard<std::mutex> lock(portfolio->mutex);
+        portfolio->lowerBound = lowerBound;
+        closePortfolio();
+    }
+    return l_True;
+}
 
-    assert(softLits.size() == 0);
+// The upper bound is posted once as a weight constraint on the soft literals, guarded by an activation literal.
+// Its required weight also includes the offset from the first bound encoded by the assumed values of some bit literals,
+// so that each model tightens the bound by changing assumptions, and learned clauses remain valid until the constraint is removed.
+// Models of cost equal to the optimum are cut, so the optimum cannot be enumerated after a search using this constraint proved it.
+bool MaxSAT::addUpperBoundConstraint(UpperBoundConstraint& c) {
+    assert(decisionLevel() == 0);
+    assert(upperBound != INT64_MAX);
+    if(c.activation != lit_Undef) return true;
 
-    printLowerBound();
-    printOptimum();
-    if(option_n == 1) onModel();
-    else enumerateModels();
-    onDoneIteration();
+    vec<Lit> lits;
+    vec<int64_t> ws;
+    int64_t sum = 0;
+    for(int i = 0; i < softLits.size(); i++) {
+        int64_t w = weights[var(softLits[i])];
+        if(w == 0) continue;
+        lits.push(softLits[i]);
+        ws.push(w);
+        sum += w;
+    }
+    int64_t bound = sum - (upperBound - lowerBound - 1);
+    if(bound <= 0) return false;
+
+    newVar();
+    c.activation = mkLit(nVars()-1);
+    setFrozen(var(c.activation), true);
+    lits.push(~c.activation);
+    ws.push(bound);
+    for(int64_t weight = 1; weight < upperBound - lowerBound; weight *= 2) {
+        newVar();
+        c.bits.push(mkLit(nVars()-1));
+        setFrozen(nVars()-1, true);
+        lits.push(~c.bits.last());
+        ws.push(weight);
+        bound += weight;
+    }
+    c.upperBound = upperBound;
+    trace(maxsat, 8, "Add upper bound constraint with " << c.bits.size() << " bits");
+    wcPropagator.addGreaterEqual(lits, ws, bound);
+    return true;
+}
+
+void MaxSAT::assumeUpperBoundConstraint(const UpperBoundConstraint& c) {
+    assert(c.activation != lit_Undef);
+    assumptions.push(c.activation);
+    int64_t offset = c.upperBound - upperBound;
+    for(int i = 0; i < c.bits.size(); i++) assumptions.push(((offset >> i) & 1) ? c.bits[i] : ~c.bits[i]);
+}
+
+// the activation literal is falsified, so that learned clauses depending on the bound are satisfied
+void MaxSAT::removeUpperBoundConstraint(UpperBoundConstraint& c) {
+    cancelUntil(0);
+    if(c.activation == lit_Undef) return;
+    addClause(~c.activation);
+    c.activation = lit_Undef;
+    c.bits.clear();
+}
+
+void MaxSAT::linearSearch() {
+    trace(maxsat, 4, "Search for models improving the upper bound");
+    setConfBudget(option_maxsat_linear_search);
+    UpperBoundConstraint c;
+    while(lowerBound < upperBound && !interrupted()) {
+        cancelUntil(0);
+        assumptions.clear();
+        if(upperBound != INT64_MAX) {
+            if(!addUpperBoundConstraint(c)) break;
+            assumeUpperBoundConstraint(c);
+        }
+
+        int64_t ub = upperBound;
+        solverCalls++;
+        lbool status = solveWithBudget();
+        if(status == l_True) {
+            linearSearchModels++;
+            updateUpperBound();
+        }
+        else if(status == l_False && c.activation != lit_Undef) {
+            trace(maxsat, 4, "No model improves the upper bound");
+            cancelUntil(0);
+            addToLowerBound(upperBound - lowerBound);
+        }
+        if(status != l_True || upperBound == ub) break;
+    }
+    removeUpperBoundConstraint(c);
+    budgetOff();
+    assumptions.clear();
+    // core analysis gets at least as many conflicts before the next phase
+    nextLinearSearch = conflicts + option_maxsat_linear_search;
+}
+
+// The input variables are fixed to their value in the best model, except for a neighbourhood searched under a conflict budget for models of smaller cost.
+// Neighbourhoods alternate random variables and blocks of consecutive variables (often related in encodings of timetabling and similar problems).
+// Their size grows when they contain no better model, and shrinks when the budget is exhausted.
+void MaxSAT::lns() {
+    trace(maxsat, 4, "Large-neighbourhood search");
+    UpperBoundConstraint c;
+    vec<lbool> best;
+    for(int failures = 0; failures < LNS_FAILURES && lowerBound < upperBound && !interrupted();) {
+        cancelUntil(0);
+        assumptions.clear();
+        if(!addUpperBoundConstraint(c)) break;
+        assumeUpperBoundConstraint(c);
+
+        model.copyTo(best);
+        int size = std::max(1, static_cast<int>(lnsRatio * nInputVars));
+        int first = irand(random_seed, nInputVars);
+        bool block = lnsNeighbourhoods++ % 2 == 1;
+        for(int i = 0; i < nInputVars && i < best.size(); i++) {
+            if(best[i] == l_Undef || isEliminated(i)) continue;
+            if(block ? (i - first + nInputVars) % nInputVars < size : drand(random_seed) < lnsRatio) continue;
+            assumptions.push(mkLit(i, best[i] == l_False));
+        }
+        trace(maxsat, 8, "Neighbourhood of " << (block ? "block" : "random") << " variables, ratio " << lnsRatio);
+
+        int64_t ub = upperBound;
+        solverCalls++;
+        setConfBudget(option_maxsat_lns);
+        lbool status = solveWithBudget();
+        budgetOff();
+        if(status == l_True) updateUpperBound();
+        if(upperBound < ub) { lnsImprovements++; failures = 0; continue; }
+
+        failures++;
+        if(status == l_Undef) { lnsRatio = std::max(LNS_MIN_RATIO, lnsRatio / LNS_RATIO_STEP); continue; }
+        if(status == l_True) continue;
+
+        // no fixed variable is needed to exclude better models
+        int i = 0;
+        for(; i < conflict.size(); i++) if(var(conflict[i]) < nInputVars) break;
+        if(i == conflict.size()) {
+            trace(maxsat, 4, "No model improves the upper bound");
+            cancelUntil(0);
+            addToLowerBound(upperBound - lowerBound);
+            break;
+        }
+        lnsRatio = std::min(LNS_MAX_RATIO, lnsRatio * LNS_RATIO_STEP);
+    }
+    removeUpperBoundConstraint(c);
+    assumptions.clear();
+}
+
+// Implicit hitting set algorithm: cores are not relaxed but collected, and the soft literals out of a minimum-cost hitting set of the cores are assumed.
+// A model is then optimal, and a new core is not hit by the hitting set. After each core, greedy hitting sets are checked until a model is found,
+// or a limited number of cores is collected, so that several cores are obtained for each minimum-cost hitting set. Weights are not changed, and lowerBound is absolute.
+lbool MaxSAT::solveImplicitHittingSet() {
+    assert(decisionLevel() == 0);
+    trace(maxsat, 1, "Start implicit hitting set algorithm");
+
+    // cores of preprocessing are relaxed with all of their outputs, so that the cost of a model is exact whatever soft literals are assumed
+    if(delayedConflicts.size() > 0) relaxDelayedConflicts();
+    for(int i = 0; i < lazyConstraints.size(); i++) while(lazyConstraints[i].outputs < lazyConstraints[i].bound) addLazyOutput(i, true);
+
+    // the lower bound of preprocessing is a constant term of the cost
+    int64_t offset = lowerBound;
+    HittingSet hittingSet(asynch_interrupt);
+    vec<Lit> elements;
+    vec<int> elementOf;
+    elementOf.growTo(nVars(), -1);
+    for(int i = 0; i < softLits.size(); i++) {
+        int64_t w = weights[var(softLits[i])];
+        if(w == 0) continue;
+        elementOf[var(softLits[i])] = hittingSet.addElement(w);
+        elements.push(softLits[i]);
+    }
+
+    vec<int> solution;
+    vec<bool> inSolution;
+    inSolution.growTo(elements.size(), false);
+    bool optimal = false;
+    int greedyCores = 0;
+    uint64_t budget = IHS_NODES;
+    for(;;) {
+        if(interrupted()) return l_Undef;
+        cancelUntil(0);
+        if(localSearch != NULL) syncLocalSearch();
+        if(lowerBound >= upperBound) break;
+
+        if(optimal) {
+            int64_t cost;
+            lbool status = hittingSet.solveOptimal(lowerBound - offset, upperBound - offset, budget, solution, cost);
+            if(status == l_False) { addToLowerBound(upperBound - lowerBound); break; }
+            if(status == l_True) {
+                optimalHittingSets++;
+                if(offset + cost > lowerBound) addToLowerBound(offset + cost - lowerBound);
+            }
+            else {
+                // the best hitting set found so far is checked anyway, and the next search has a larger budget
+                trace(maxsat, 4, "Hitting set search exhausted " << budget << " nodes");
+                budget *= 2;
+                if(solution.size() == 0 && hittingSet.nSets() > 0) continue;
+            }
+        }
+        else if(offset + hittingSet.solveGreedy(solution) >= upperBound) { optimal = true; continue; }
+
+        for(int i = 0; i < solution.size(); i++) inSolution[solution[i]] = true;
+        assumptions.clear();
+        for(int i = 0; i < elements.size(); i++) if(!inSolution[i]) assumptions.push(elements[i]);
+        for(int i = 0; i < solution.size(); i++) inSolution[solution[i]] = false;
+
+        trace(maxsat, 8, "Check hitting set of size " << solution.size() << (optimal ? " (optimal)" : " (greedy)"));
+        conflicts_bkp = conflicts;
+        solverCalls++;
+        lbool status = solveWithBudget();
+        if(status == l_True) {
+            // lowerBound is absolute here, while the cost of the model adds the violated soft literals to the constant term
+            int64_t sum = computeModelCost() - lowerBound + offset;
+            if(sum < upperBound) {
+                upperBound = sum;
+                copyModel();
+                publishUpperBound();
+            }
+            optimal = true;
+        }
+        else if(status == l_False) {
+            trace(maxsat, 2, "UNSAT! Conflict of size " << conflict.size());
+            if(conflict.size() == 0) { lowerBound = upperBound; break; }
+
+            shrinkConflict(1);
+            trimConflict();
+            if(interrupted()) return l_Undef;
+
+            vec<int> set;
+            for(int i = 0; i < conflict.size(); i++) {
+                assert(elementOf[var(conflict[i])] != -1);
+                set.push(elementOf[var(conflict[i])]);
+            }
+            trace(maxsat, 4, "Add core of size " << set.size() << " to the hitting set problem");
+            hittingSet.addSet(set);
+            if(optimal) greedyCores = 0;
+            optimal = ++greedyCores > IHS_GREEDY_CORES;
+        }
+        else assert(interrupted());
+    }
+    cancelUntil(0);
+    assumptions.clear();
+    statistics(print_statistics(maxsat, "implicit hitting set: " << hittingSet.nSets() << " cores; " << optimalHittingSets << " optimal hitting sets; " << hittingSet.getNodes() << " nodes"));
+    return l_True;
+}
+
+void MaxSAT::configure(int engine) {
+    // engine 0 runs with the given options, the others flip them according to the bits of their index
+    if(engine & 1) usePreferences = !usePreferences;
+    if(engine & 2) stratification = stratification == 0 ? 1 : 0;
+    if(engine & 4) minShrinkBudget *= 10;
+    // from the ninth engine on, variants are repeated with random decisions
+    if(engine >= 8) {
+        random_seed += engine;
+        if(random_var_freq == 0) random_var_freq = 0.01;
+    }
+    setId("engine " + std::to_string(engine));
+}
+
+lbool MaxSAT::solvePortfolio() {
+    assert(decisionLevel() == 0);
+    trace(maxsat, 1, "Start portfolio of " << option_maxsat_portfolio << " engines");
+
+    Portfolio shared;
+    shared.lowerBound = lowerBound;
+    shared.upperBound = upperBound;
+    model.copyTo(shared.model);
+    shared.nVars = nVars();
+    shared.closed = false;
+    shared.engines.push(this);
+    for(int i = 1; i < option_maxsat_portfolio; i++) {
+        MaxSAT* engine = new MaxSAT(*this);
+        engine->configure(i);
+        engine->portfolio = &shared;
+        shared.engines.push(engine);
+    }
+    configure(0);
+    portfolio = &shared;
+
+    std::vector<std::thread> threads;
+    for(int i = 1; i < shared.engines.size(); i++) {
+        MaxSAT* engine = shared.engines[i];
+        threads.push_back(std::thread([engine]() { engine->optimize(); }));
+    }
+    optimize();
+    // this engine may have been interrupted before the others were started
+    for(int i = 1; i < shared.engines.size(); i++) shared.engines[i]->GlucoseWrapper::interrupt();
+    for(unsigned i = 0; i < threads.size(); i++) threads[i].join();
+
+    portfolio = NULL;
+    for(int i = 1; i < shared.engines.size(); i++) delete shared.engines[i];
+
+    upperBound = shared.upperBound;
+    shared.model.copyTo(model);
+    if(!shared.closed) { onInterrupt(); return l_Undef; }
+
+    clearInterrupt();
+    lowerBound = upperBound;
     return l_True;
 }
 
+void MaxSAT::syncPortfolio() {
+    assert(decisionLevel() == 0);
+    std::lock_guard<std::mutex> lock(portfolio->mutex);
+    // the model comes with the bound, as it is printed by the engine closing the portfolio
+    if(portfolio->upperBound < upperBound) {
+        upperBound = portfolio->upperBound;
+        portfolio->model.copyTo(model);
+    }
+    for(; nImportedHardened < portfolio->hardened.size(); nImportedHardened++) addClause(portfolio->hardened[nImportedHardened]);
+}
+
+// the best assignment of local search also seeds the phases of the solver
+void MaxSAT::syncLocalSearch() {
+    cancelUntil(0);
+    int64_t cost;
+    vec<lbool> assignment;
+    if(!localSearch->importModel(upperBound, cost, assignment)) return;
+    trace(maxsat, 4, "Import model of cost " << cost << " from local search");
+    upperBound = cost;
+    model.clear();
+    model.growTo(nVars(), l_Undef);
+    for(int i = 0; i < assignment.size(); i++) {
+        model[i] = assignment[i];
+        polarity[i] = assignment[i] == l_False;
+    }
+    publishUpperBound();
+}
+
+// the caller must hold the mutex of the portfolio
+void MaxSAT::closePortfolio() {
+    portfolio->closed = true;
+    for(int i = 0; i < portfolio->engines.size(); i++) portfolio->engines[i]->GlucoseWrapper::interrupt();
+}
+
 void MaxSAT::enumerateModels() {
     assert(!option_maxsat_top_k);
     assert(decisionLevel() == 0);
@@ -18,8 +18,16 @@
 #ifndef zuccherino_maxsat_h
 #define zuccherino_maxsat_h
 
-#include "GlucoseWrapper.h"
+#include "StaticSolver.h"
 #include "CardinalityConstraint.h"
+#include "WeightConstraint.h"
+#include "LocalSearch.h"
+#include "utils/ThreadPool.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <random>
 
 namespace zuccherino {
 
@@ -57,9 +65,12 @@ private:
     vec<Lit> lits;
 };
 
-class MaxSAT : public GlucoseWrapper {
+class MaxSAT : public StaticGlucoseWrapper<CardinalityConstraintPropagator, WeightConstraintPropagator> {
 public:
     MaxSAT();
+    // an engine of a portfolio, starting from the state of init (at decision level 0)
+    MaxSAT(const MaxSAT& init);
+    ~MaxSAT();
     
     void interrupt();
     
@@ -68,44 +79,177 @@ public:
     void parse(gzFile in);
     lbool solve();
     
+    inline void setInputVars(int value) { nInputVars = value; setLastVisibleVar(value); }
+    void addHardClause(vec<Lit>& lits);
     void addWeightedClause(vec<Lit>& lits, int64_t weight);
     
 private:
     MaxSATParserProlog parserProlog;
     MaxSATParserClause parserClause;
     CardinalityConstraintPropagator ccPropagator;
+    WeightConstraintPropagator wcPropagator;
+
+    // configuration of the engine; engines of a portfolio differ in these values
+    int stratification;
+    bool usePreferences;
+    uint64_t minShrinkBudget;
 
     vec<Lit> softLits;
     vec<int64_t> weights;
+    // number of soft literals of each positive weight, to find the next stratification level without scanning softLits
+    std::map<int64_t, int> weightIndex;
+    int strata = 0;
+    
+    // constraints of kdyn whose outputs are created lazily: the i-th output o_i is defined by o_i -> lits >= bound-i+1
+    struct LazyConstraint {
+        vec<Lit> lits;
+        int bound;
+        int outputs;
+        Lit last;
+        int64_t weight;
+    };
+    vec<LazyConstraint> lazyConstraints;
+    // index of the lazy constraint whose last output is the variable, if more outputs can be created; -1 otherwise
+    vec<int> lazyConstraintOf;
+    
+    // cores whose weight is already subtracted from their soft literals, waiting to be relaxed (weight-aware core extraction)
+    struct DelayedConflict {
+        vec<Lit> lits;
+        int64_t weight;
+    };
+    vec<DelayedConflict> delayedConflicts;
+    
+    int nInputVars = 0;
     
     int64_t lowerBound;
     int64_t upperBound;
     
     uint64_t conflicts_bkp;
+    uint64_t nextLinearSearch = 0;
+    
+    uint64_t solverCalls = 0;
+    uint64_t relaxedDelayedConflicts = 0;
+    uint64_t relaxationBatches = 0;
+    uint64_t savedSolverCalls = 0;
+    uint64_t linearSearchModels = 0;
+    uint64_t lnsImprovements = 0;
+    
+    // fraction of the input variables left free in each neighbourhood of lns, adapted during the search
+    static constexpr double LNS_MIN_RATIO = 0.01;
+    static constexpr double LNS_MAX_RATIO = 0.9;
+    static constexpr double LNS_RATIO_STEP = 1.5;
+    static const int LNS_FAILURES = 10;
+    double lnsRatio = 0.1;
+    int lnsNeighbourhoods = 0;
+    
+    // nodes of the first search for a minimum-cost hitting set, doubled each time they are not enough
+    static const uint64_t IHS_NODES = 100000;
+    // cores of greedy hitting sets before a minimum-cost hitting set is computed again
+    static const int IHS_GREEDY_CORES = 20;
+    uint64_t optimalHittingSets = 0;
+    
+    // bounds, hardened soft literals and best model shared by the engines of a portfolio (NULL if not in a portfolio)
+    struct Portfolio;
+    Portfolio* portfolio;
+    int nImportedHardened;
+    
+    // engine run in a parallel thread on the input clauses (NULL if not enabled)
+    LocalSearch* localSearch;
+    
+    // threads and engines shrinking copies of each core (NULL and empty if not enabled)
+    ThreadPool* shrinkPool = NULL;
+    vec<MaxSAT*> shrinkEngines;
+    // held while shrinkEngines or disjointCoreEngines are changed, as interrupt() reads them from a signal handler
+    std::atomic<bool> enginesLocked{false};
+    std::mt19937 shrinkRandom;
+    uint64_t parallelShrinks = 0;
+    uint64_t parallelShrinkImprovements = 0;
+    uint64_t shrinkEngineCopies = 0;
+    
+    // cores found by the engines searching for disjoint cores, and the soft literals they contain
+    struct DisjointCores {
+        std::mutex mutex;
+        vec<bool> used;
+        vec<vec<Lit> > cores;
+    };
+    // conflicts of each call searching for a disjoint core
+    static const uint64_t DISJOINT_CORES_BUDGET = 1000;
+    // this engine and its copies while searching for disjoint cores (empty otherwise); guarded by enginesLocked
+    vec<MaxSAT*> disjointCoreEngines;
+    
+    void configure(int engine);
+    void onInterrupt();
+    void interruptEngines();
+    void lockEngines();
+    void unlockEngines();
+    lbool solvePortfolio();
+    void syncPortfolio();
+    void closePortfolio();
+    void syncLocalSearch();
     
     void addToLowerBound(int64_t value);
+    // cost of the current assignment, an upper bound of the cost of its values for the input soft literals
+    int64_t computeModelCost() const;
+    bool hasExactCost() const;
     void updateUpperBound();
+    void publishUpperBound();
     
     void hardening();
-    int64_t computeNextLimit(int64_t limit) const;
+    void setWeight(Var v, int64_t weight);
+    int64_t computeNextLimit(int64_t limit);
     void setAssumptions(int64_t limit);
     
     void trimConflict();
     void shrinkConflict(int64_t limit);
+    void shrinkTrimmedConflict(int64_t limit);
+    void parallelShrinkConflict(int64_t limit);
+    void copyShrinkEngine(int index);
+    bool shrinkCopiedConflict(int64_t limit);
     int64_t computeConflictWeight() const;
     void processConflict(int64_t weight);
+    void reduceWeights(int64_t weight);
+    void relaxConflict(int64_t weight);
+    void delayConflict(int64_t weight);
+    void relaxDelayedConflicts();
+    Lit addLazyOutput(int constraint, bool soft);
     void preprocess();
+    void findInputCores();
+    void findDisjointCores(int threads);
+    void searchDisjointCores(const vec<int64_t>& limits, int index, int engines, DisjointCores& shared);
     
     void enumerateModels();
     
+    lbool optimize();
+    
+    // soft literals of cost less than the upper bound when activation is assumed; the bound is tightened by assuming bit literals
+    struct UpperBoundConstraint {
+        Lit activation = lit_Undef;
+        vec<Lit> bits;
+        int64_t upperBound;
+    };
+    bool addUpperBoundConstraint(UpperBoundConstraint& c);
+    void assumeUpperBoundConstraint(const UpperBoundConstraint& c);
+    void removeUpperBoundConstraint(UpperBoundConstraint& c);
+    void linearSearch();
+    void lns();
+    
+    lbool solveImplicitHittingSet();
+    
     lbool solveExperimental();
     void sortSoftByWeight();
 
     inline void printLowerBound() const { cout << "c lb " << lowerBound << endl; }
     inline void printUpperBound() const { cout << "c ub " << upperBound << endl; }
+    inline void printSavedSolverCalls() const { cout << "c wce " << relaxedDelayedConflicts << " cores relaxed in " << relaxationBatches << " batches, " << savedSolverCalls << " solver calls saved" << endl; }
     inline void printOptimum() const { cout << "o " << upperBound << "\ns OPTIMUM FOUND" << endl; }
 
     lbool solve_top_k();
+    struct TopKCandidate {
+        int64_t cost;
+        vec<lbool> model;
+    };
+    uint64_t topKCandidatesUsed = 0;
+    void addTopKCandidate(vec<TopKCandidate>& candidates, const vec<Lit>& originalSoftLits, int max);
 
 };
 
@@ -0,0 +1,84 @@
+/*
+ *  Copyright (C) 2017  Mario Alviano (mario@alviano.net)
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+
+#ifndef zuccherino_occurrences_h
+#define zuccherino_occurrences_h
+
+#include "utils/common.h"
+
+namespace zuccherino {
+
+// Occurrence lists stored in a single pool, one contiguous slice per key (compressed sparse rows).
+// New elements are kept aside until build(), which appends them to their slices preserving the insertion order.
+// Keys are small integers, usually toInt(lit) or a variable.
+template<typename T>
+class Occurrences {
+public:
+    inline bool dirty() const { return pending.size() > 0; }
+    inline void build() { if(dirty()) rebuild(); }
+
+    inline int size(int key) const { assert(!dirty()); return key + 1 < start.size() ? start[key+1] - start[key] : 0; }
+    inline T& operator()(int key, int index) { assert(!dirty()); assert(index < size(key)); return pool[start[key] + index]; }
+    inline const T& operator()(int key, int index) const { assert(!dirty()); assert(index < size(key)); return pool[start[key] + index]; }
+
+    inline void push(int key, const T& value) { assert(key >= 0); pending.push(Pending(key, value)); }
+
+private:
+    struct Pending {
+        inline Pending() {}
+        inline Pending(int key_, const T& value_) : key(key_), value(value_) {}
+        int key;
+        T value;
+    };
+
+    vec<int> start;
+    vec<T> pool;
+    vec<Pending> pending;
+
+    void rebuild();
+};
+
+template<typename T>
+void Occurrences<T>::rebuild() {
+    int keys = start.size() > 0 ? start.size() - 1 : 0;
+    for(int i = 0; i < pending.size(); i++) if(pending[i].key >= keys) keys = pending[i].key + 1;
+
+    vec<int> newStart;
+    newStart.growTo(keys + 1, 0);
+    for(int key = 0; key + 1 < start.size(); key++) newStart[key+1] = start[key+1] - start[key];
+    for(int i = 0; i < pending.size(); i++) newStart[pending[i].key + 1]++;
+    for(int key = 0; key < keys; key++) newStart[key+1] += newStart[key];
+
+    vec<T> newPool;
+    newPool.growTo(newStart[keys]);
+    vec<int> next;
+    next.growTo(keys);
+    for(int key = 0; key < keys; key++) {
+        next[key] = newStart[key];
+        if(key + 1 < start.size()) for(int i = start[key]; i < start[key+1]; i++) newPool[next[key]++] = pool[i];
+    }
+    for(int i = 0; i < pending.size(); i++) newPool[next[pending[i].key]++] = pending[i].value;
+
+    newStart.moveTo(start);
+    newPool.moveTo(pool);
+    pending.clear(true);
+}
+
+}
+
+#endif
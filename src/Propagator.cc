@@ -17,16 +17,25 @@
 
 #include "Propagator.h"
 
-#include "GlucoseWrapper.h"
+#include "EmbeddedSolver.h"
+
+Glucose::BoolOption option_restore_on_cancel("PROPAGATORS", "restore-on-cancel", "Restore cardinality and weight constraints on backtracking from per-level backups instead of undoing each assignment.", false);
+Glucose::IntOption option_reason_cache("PROPAGATORS", "reason-cache", "Turn the reason of a literal inferred by a propagator into a learnt clause after this number of requests (0 to disable).", 0, Glucose::IntRange(0, INT32_MAX));
+Glucose::BoolOption option_inline_watches("PROPAGATORS", "inline-watches", "Wake up cardinality and weight constraints from unit propagation via literal watches instead of scanning the trail.", false);
 
 namespace zuccherino {
 
-Propagator::Propagator(GlucoseWrapper& solver_) : solver(solver_) {
+Propagator::Propagator(EmbeddedSolver& solver_, Priority priority_) : solver(solver_), inlineWatches(option_inline_watches), index(-1), priority(priority_), cost(0), calls(0) {
     solver.add(this);
 }
 
-Propagator::Propagator(GlucoseWrapper& solver_, const Propagator& /*init*/) : solver(solver_) {
+Propagator::Propagator(EmbeddedSolver& solver_, const Propagator& init) : solver(solver_), inlineWatches(init.inlineWatches), index(-1), priority(init.priority), cost(0), calls(0) {
     solver.add(this);
 }
 
+void Propagator::watch(Lit lit) {
+    assert(inlineWatches);
+    solver.watch(lit, this);
+}
+
 }
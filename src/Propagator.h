@@ -22,25 +22,45 @@
 
 namespace zuccherino {
 
-class GlucoseWrapper;
+class EmbeddedSolver;
 
 class Propagator {
+    friend class EmbeddedSolver;
 public:
-    Propagator(GlucoseWrapper& solver);
-    Propagator(GlucoseWrapper& solver, const Propagator& init);
+    // Propagators are run by increasing priority class: a class is run only after the cheaper ones reached a fixpoint.
+    // StaticSolver runs its propagators in the order of its list instead.
+    enum Priority { PRIORITY_CHEAP = 0, PRIORITY_MEDIUM, PRIORITY_EXPENSIVE, PRIORITIES };
+    
+    Propagator(EmbeddedSolver& solver, Priority priority = PRIORITY_CHEAP);
+    Propagator(EmbeddedSolver& solver, const Propagator& init);
     virtual ~Propagator() {}
     
+    inline Priority getPriority() const { return priority; }
+    
     virtual bool activate() = 0;
     
     virtual void onCancel() = 0;
     virtual bool simplify() = 0;
     virtual bool propagate() = 0;
+    // invoked by Solver::propagate for each literal registered by watch(): returns false if a conflict is derived
+    virtual bool onWatched(Lit) { return true; }
     
+    // ret is an empty buffer owned by the solver and reused across calls: append to it, do not move it
     virtual void getConflict(vec<Lit>& ret) = 0;
     virtual void getReason(Lit lit, vec<Lit>& ret) = 0;
     
 protected:
-    GlucoseWrapper& solver;
+    EmbeddedSolver& solver;
+    // if true, propagators supporting watches call watch() instead of scanning the trail in propagate()
+    bool inlineWatches;
+    
+    void watch(Lit lit);
+
+private:
+    int index;  // position in EmbeddedSolver::propagatorsByIndex
+    Priority priority;
+    double cost;
+    unsigned calls;
 };
 
 }
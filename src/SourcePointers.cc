@@ -17,17 +17,24 @@
 
 #include "SourcePointers.h"
 
-#include "GlucoseWrapper.h"
+#include "EmbeddedSolver.h"
+
+Glucose::BoolOption option_sp_shared_reasons("SP", "sp-shared-reasons", "Explain atoms of an unfounded set with the external bodies of the whole set, computed once per set.", true);
 
 namespace zuccherino {
 
-SourcePointers::SourcePointers(GlucoseWrapper& solver, const SourcePointers& init) : Propagator(solver, init), nextToPropagate(init.nextToPropagate), conflictLit(init.conflictLit), data(init.data) {
+SourcePointers::SourcePointers(EmbeddedSolver& solver) : Propagator(solver, PRIORITY_MEDIUM), nextToPropagate(0), sharedReasons(option_sp_shared_reasons), nUnfoundedSets(0) {
+}
+
+SourcePointers::SourcePointers(EmbeddedSolver& solver, const SourcePointers& init) : Propagator(solver, init), nextToPropagate(init.nextToPropagate), conflictLit(init.conflictLit), sharedReasons(init.sharedReasons), data(init.data), hot(init.hot), spOfs(init.spOfs), inRecBodies(init.inRecBodies), nUnfoundedSets(0) {
+    assert(init.nUnfoundedSets == 0);
     init.flagged.copyTo(flagged);
     init.flagged2.copyTo(flagged2);
 }
     
 void SourcePointers::onCancel() {
     nextToPropagate = solver.nAssigns();    
+    while(nUnfoundedSets > 0 && unfoundedSets[nUnfoundedSets-1].begin >= solver.nAssigns()) nUnfoundedSets--;
 }
 
 void SourcePointers::removeSp() {
@@ -35,24 +42,24 @@ void SourcePointers::removeSp() {
     vec<Var> queue;
     while(nextToPropagate < solver.nAssigns()) {
         Lit lit = solver.assigned(nextToPropagate);
-        if(data.has(~lit)) {
-            trace(sp, 5, "Propagate " << lit << "@" << solver.decisionLevel());
-            vec<Var>& s = spOf(~lit);
-            for(int i = 0; i < s.size(); i++) {
-                if(sp(s[i]) != ~lit) continue;
-                if(!addToSpLost(s[i])) continue;
-                queue.push(s[i]);
-            }
+        int n = nSpOf(~lit);
+        if(n == 0) { nextToPropagate++; continue; }
+        trace(sp, 5, "Propagate " << lit << "@" << solver.decisionLevel());
+        for(int i = 0; i < n; i++) {
+            Var v = spOf(~lit, i);
+            if(sp(v) != ~lit) continue;
+            if(!addToSpLost(v)) continue;
+            queue.push(v);
         }
         nextToPropagate++;
     }
     for(int q = 0; q < queue.size(); q++) {
         Var v = queue[q];
-        vec<SuppIndex>& rec = inRecBody(v);
-        for(int i = 0; i < rec.size(); i++) {
-            if(sp(rec[i].var) != supp(rec[i]).body) continue;
-            if(!addToSpLost(rec[i].var)) continue;
-            queue.push(rec[i].var);
+        for(int i = 0; i < nInRecBody(v); i++) {
+            SuppIndex rec = inRecBody(v, i);
+            if(sp(rec.var) != supp(rec).body) continue;
+            if(!addToSpLost(rec.var)) continue;
+            queue.push(rec.var);
         }
     }
 }
@@ -86,6 +93,8 @@ bool SourcePointers::checkInferences() {
     }
     assert(lits.size() > 0);
     trace(sp, 20, "Infer " << lits << "@" << solver.decisionLevel());
+    // reasons are not requested for atoms inferred at level 0
+    if(sharedReasons && solver.decisionLevel() > 0) addUnfoundedSet(lits);
     solver.uncheckedEnqueueFromPropagator(lits, this);
     resetFlagged();
     return true;
@@ -128,13 +137,13 @@ void SourcePointers::rebuildSp() {
         trace(sp, 10, "Set sp of " << mkLit(v) << " to " << lit);
         sp(v) = lit;
 
-        vec<SuppIndex>& rec = inRecBody(v);
-        for(int i = 0; i < rec.size(); i++) {
-            if(!flag(rec[i].var)) continue;
-            SuppData& s = supp(rec[i]);
+        for(int i = 0; i < nInRecBody(v); i++) {
+            SuppIndex rec = inRecBody(v, i);
+            if(!flag(rec.var)) continue;
+            SuppData& s = supp(rec);
             if(!canBeSp(s)) continue;
-            queue.push(VarLit(rec[i].var, s.body));
-            flag(rec[i].var, false);
+            queue.push(VarLit(rec.var, s.body));
+            flag(rec.var, false);
         }
     }    
 
@@ -182,6 +191,8 @@ bool SourcePointers::addToSpLost(Var v) {
 bool SourcePointers::activate() {
     assert(solver.decisionLevel() == 0);
     trace(sp, 1, "Activate");
+    spOfs.build();
+    inRecBodies.build();
     for(int i = 0; i < data.vars(); i++) addToSpLost(data.var(i));
     if(!checkInferences()) return solver.addEmptyClause();
     return true;
@@ -191,25 +202,47 @@ void SourcePointers::add(Var atom, Lit body, vec<Var>& rec) {
     if(!data.has(atom)) data.push(solver, atom);
     if(!data.has(body)) data.push(solver, body);
     for(int i = 0; i < rec.size(); i++) if(!data.has(rec[i])) data.push(solver, rec[i]);
+    while(hot.size() <= atom) hot.push();
+    for(int i = 0; i < rec.size(); i++) while(hot.size() <= rec[i]) hot.push();
     
     supp(atom).push();
     SuppData& s = supp(atom).last();
     s.body = body;
-    spOf(body).push(atom);
+    spOfs.push(toInt(body), atom);
     for(int i = 0; i < rec.size(); i++) {
         s.rec.push(rec[i]);
-        inRecBody(rec[i]).push(SuppIndex::create(atom, supp(atom).size()-1));
+        inRecBodies.push(rec[i], SuppIndex::create(atom, supp(atom).size()-1));
     }
     
     rec.clear();
 }
 
+void SourcePointers::addUnfoundedSet(vec<Lit>& lits) {
+    if(nUnfoundedSets == unfoundedSets.size()) unfoundedSets.push();
+    UnfoundedSet& set = unfoundedSets[nUnfoundedSets];
+    set.begin = solver.nAssigns();
+    set.size = lits.size();
+    set.explained = false;
+    set.reason.clear();
+    for(int i = 0; i < lits.size(); i++) data(var(lits[i])).unfoundedSet = nUnfoundedSets;
+    nUnfoundedSets++;
+}
+
 void SourcePointers::getReason(Lit lit, vec<Lit>& ret) {
     assert(ret.size() == 0);
     assert(sign(lit));
     assert(flagged.size() == 0);
     
-    computeReason(lit, ret);
+    if(sharedReasons) {
+        assert(solver.level(var(lit)) > 0);
+        UnfoundedSet& set = unfoundedSets[data(var(lit)).unfoundedSet];
+        assert(data(var(lit)).unfoundedSet < nUnfoundedSets);
+        assert(set.begin <= solver.assignedIndex(lit) && solver.assignedIndex(lit) < set.begin + set.size);
+        explainUnfoundedSet(set);
+        ret.push(lit);
+        for(int i = 0; i < set.reason.size(); i++) ret.push(set.reason[i]);
+    }
+    else computeReason(lit, ret);
     
     trace(sp, 25, "Reason: " << ret);
 }
@@ -241,8 +274,26 @@ void SourcePointers::computeReason(Lit lit, vec<Lit>& ret) {
     trace(sp, 20, "Computing reason for " << lit);
     
     ret.push(lit);
-    vec<Var> stack;
-    stack.push(var(lit));
+    assert(reasonStack.size() == 0);
+    reasonStack.push(var(lit));
+    explain(ret);
+}
+
+void SourcePointers::explainUnfoundedSet(UnfoundedSet& set) {
+    if(set.explained) { statistics(reusedExplanations++;) return; }
+    trace(sp, 20, "Computing reason for the unfounded set of " << set.size << " atoms at " << set.begin);
+    assert(set.reason.size() == 0);
+    assert(reasonStack.size() == 0);
+    for(int i = 0; i < set.size; i++) reasonStack.push(var(solver.assigned(set.begin + i)));
+    explain(set.reason);
+    set.explained = true;
+    statistics(explainedSets++;)
+}
+
+// collects the false bodies supporting the atoms in reasonStack and the atoms of their unfounded set reachable from them
+void SourcePointers::explain(vec<Lit>& ret) {
+    assert(flagged2.size() == 0);
+    vec<Var>& stack = reasonStack;
     do{
         Var v = stack.last();
         int index = flag(v) ? solver.nAssigns() : solver.assignedIndex(v);
@@ -19,14 +19,15 @@
 #define zuccherino_source_pointers_h
 
 #include "Data.h"
+#include "Occurrences.h"
 #include "Propagator.h"
 
 namespace zuccherino {
 
 class SourcePointers: public Propagator {
 public:
-    inline SourcePointers(GlucoseWrapper& solver) : Propagator(solver), nextToPropagate(0) {}
-    SourcePointers(GlucoseWrapper& solver, const SourcePointers& init);
+    SourcePointers(EmbeddedSolver& solver);
+    SourcePointers(EmbeddedSolver& solver, const SourcePointers& init);
     
     virtual bool activate();
     
@@ -39,9 +40,14 @@ public:
 
     void add(Var atom, Lit body, vec<Var>& rec);
 
+    // explanations computed for unfounded sets, and reasons of their atoms answered with a computed explanation
+    inline uint64_t getExplainedSets() const { return explainedSets; }
+    inline uint64_t getReusedExplanations() const { return reusedExplanations; }
+
 private:
     int nextToPropagate;
     Lit conflictLit;
+    bool sharedReasons;
     
     struct SuppIndex {
         static inline SuppIndex create(Var v, unsigned i) { SuppIndex res; res.var = v; res.index = i; return res; }
@@ -53,32 +59,55 @@ private:
         vec<Var> rec;
     };
     struct VarData : VarDataBase {
-        inline VarData() : flag(0), flag2(0) {}
-        Lit sp;
         vec<SuppData> supp;
-        vec<SuppIndex> inRecBody;
+        // index in unfoundedSets of the set in which the atom was inferred
+        int unfoundedSet;
+    };
+    struct LitData : LitDataBase {};
+    // fields used during propagation, stored in a dense array indexed by variable
+    struct HotVarData {
+        inline HotVarData() : sp(lit_Undef), flag(0), flag2(0) {}
+        Lit sp;
         unsigned flag:1;
         unsigned flag2:1;
     };
-    struct LitData : LitDataBase {
-        vec<Var> spOf;
-    };
 
     Data<VarData, LitData> data;
+    vec<HotVarData> hot;
+    // occurrence lists are built at activation
+    Occurrences<Var> spOfs;             // key toInt(lit)
+    Occurrences<SuppIndex> inRecBodies; // key var
     
-    inline Lit& sp(Var v) { return data(v).sp; }
+    inline Lit& sp(Var v) { return hot[v].sp; }
     inline vec<SuppData>& supp(Var v) { return data(v).supp; }
     inline SuppData& supp(SuppIndex i) { return supp(i.var)[i.index]; }
-    inline vec<SuppIndex>& inRecBody(Var v) { return data(v).inRecBody; }
-    inline bool flag(Var v) const { return data(v).flag; }
-    inline void flag(Var v, bool x) { data(v).flag = x; }
-    inline bool flag2(Var v) const { return data(v).flag2; }
-    inline void flag2(Var v, bool x) { data(v).flag2 = x; }
+    inline int nInRecBody(Var v) const { return inRecBodies.size(v); }
+    inline SuppIndex inRecBody(Var v, int index) const { return inRecBodies(v, index); }
+    inline bool flag(Var v) const { return hot[v].flag; }
+    inline void flag(Var v, bool x) { hot[v].flag = x; }
+    inline bool flag2(Var v) const { return hot[v].flag2; }
+    inline void flag2(Var v, bool x) { hot[v].flag2 = x; }
     
-    inline vec<Var>& spOf(Lit lit) { return data(lit).spOf; }
+    inline int nSpOf(Lit lit) const { return spOfs.size(toInt(lit)); }
+    inline Var spOf(Lit lit, int index) const { return spOfs(toInt(lit), index); }
     
     vec<Var> flagged;
     vec<Var> flagged2;
+    vec<Var> reasonStack;
+
+    // Atoms inferred at once form an unfounded set, and the external bodies of the whole set are a reason for each of them.
+    // The explanation is computed on the first request of a reason, and reused for the other atoms of the set.
+    struct UnfoundedSet {
+        int begin; // position of the first atom in the trail; the others follow
+        int size;
+        bool explained;
+        vec<Lit> reason; // without the inferred literal
+    };
+    // entries after nUnfoundedSets are undone, and kept to reuse their buffers
+    vec<UnfoundedSet> unfoundedSets;
+    int nUnfoundedSets;
+    uint64_t explainedSets = 0;
+    uint64_t reusedExplanations = 0;
     bool addToFlagged(Var v);
     void resetFlagged();
     bool addToFlagged2(Var v);
@@ -92,7 +121,10 @@ private:
     bool checkInferences();
     void removeSp();
     
+    void addUnfoundedSet(vec<Lit>& lits);
     void computeReason(Lit lit, vec<Lit>& ret);
+    void explainUnfoundedSet(UnfoundedSet& set);
+    void explain(vec<Lit>& ret);
 };
 
 }
@@ -0,0 +1,153 @@
+/*
+ *  Copyright (C) 2017  Mario Alviano (mario@alviano.net)
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+#ifndef zuccherino_static_solver_h
+#define zuccherino_static_solver_h
+
+#include "GlucoseWrapper.h"
+
+#include <tuple>
+#include <type_traits>
+
+namespace zuccherino {
+
+// A solver whose propagators are known at compile time; Base is GlucoseWrapper or EmbeddedSolver.
+// Propagators are invoked through qualified (non-virtual) calls, so that their hooks can be inlined in the search loop.
+// Propagators still register themselves in EmbeddedSolver, and the derived class must bind them with setPropagators().
+// They run in the order of Ps: priority classes and measured costs are not used, and they are not counted in the statistics per class.
+template<typename Base, typename... Ps>
+class StaticSolver : public Base {
+public:
+    inline StaticSolver() {}
+    inline StaticSolver(const StaticSolver& init) : Base(init) {}
+
+    virtual void cancelUntil(int level);
+
+    virtual bool simplifyPropagators();
+    virtual bool propagatePropagators();
+    virtual bool propagatePropagatorWatches(Lit lit);
+    virtual bool reasonPropagators(Lit lit, Glucose::vec<Lit>& reason);
+    using Base::reasonPropagators;
+
+protected:
+    inline void setPropagators(Ps&... ps) { list = std::make_tuple(&ps...); }
+
+private:
+    typedef std::tuple<Ps*...> List;
+    List list;
+
+    template<int I> using P = typename std::tuple_element<I, std::tuple<Ps...> >::type;
+    enum { N = sizeof...(Ps) };
+
+    template<int I = 0> inline typename std::enable_if<(I == N)>::type cancel_() {}
+    template<int I = 0> inline typename std::enable_if<(I < N)>::type cancel_() {
+        std::get<I>(list)->P<I>::onCancel();
+        cancel_<I+1>();
+    }
+
+    template<int I = 0> inline typename std::enable_if<(I == N), bool>::type simplify_(int) { return true; }
+    template<int I = 0> inline typename std::enable_if<(I < N), bool>::type simplify_(int n) {
+        if(!std::get<I>(list)->P<I>::simplify()) return false;
+        if(this->nAssigns() > n) return true;
+        return simplify_<I+1>(n);
+    }
+
+    template<int I = 0> inline typename std::enable_if<(I == N), bool>::type propagate_(int) { return true; }
+    template<int I = 0> inline typename std::enable_if<(I < N), bool>::type propagate_(int n) {
+        if(!std::get<I>(list)->P<I>::propagate()) {
+            this->conflictFromPropagators.clear();
+            std::get<I>(list)->P<I>::getConflict(this->conflictFromPropagators);
+            return false;
+        }
+        if(this->nAssigns() > n) return true;
+        return propagate_<I+1>(n);
+    }
+
+    template<int I = 0> inline typename std::enable_if<(I == N), bool>::type onWatched_(Propagator*, Lit) { assert(false); return true; }
+    template<int I = 0> inline typename std::enable_if<(I < N), bool>::type onWatched_(Propagator* p, Lit lit) {
+        if(p != std::get<I>(list)) return onWatched_<I+1>(p, lit);
+        if(std::get<I>(list)->P<I>::onWatched(lit)) return true;
+        // at level 0 the conflict is not analyzed
+        if(this->decisionLevel() > 0) {
+            this->conflictFromPropagators.clear();
+            std::get<I>(list)->P<I>::getConflict(this->conflictFromPropagators);
+        }
+        return false;
+    }
+
+    template<int I = 0> inline typename std::enable_if<(I == N)>::type getReason_(Propagator*, Lit, vec<Lit>&) { assert(false); }
+    template<int I = 0> inline typename std::enable_if<(I < N)>::type getReason_(Propagator* p, Lit lit, vec<Lit>& ret) {
+        if(p == std::get<I>(list)) std::get<I>(list)->P<I>::getReason(lit, ret);
+        else getReason_<I+1>(p, lit, ret);
+    }
+};
+
+template<typename... Ps> using StaticGlucoseWrapper = StaticSolver<GlucoseWrapper, Ps...>;
+template<typename... Ps> using StaticEmbeddedSolver = StaticSolver<EmbeddedSolver, Ps...>;
+
+template<typename Base, typename... Ps>
+void StaticSolver<Base, Ps...>::cancelUntil(int level) {
+    if(this->decisionLevel() <= level) return;
+    Glucose::SimpSolver::cancelUntil(level);
+    cancel_();
+    this->resetTrailPositions();
+}
+
+template<typename Base, typename... Ps>
+bool StaticSolver<Base, Ps...>::simplifyPropagators() {
+    assert(this->decisionLevel() == 0);
+    this->updateTrailPositions();
+    if(!simplify_(this->nAssigns())) return this->ok = false;
+    return true;
+}
+
+template<typename Base, typename... Ps>
+bool StaticSolver<Base, Ps...>::propagatePropagators() {
+    if(this->decisionLevel() == 0) return simplifyPropagators();
+
+    assert(this->decisionLevel() > 0);
+    this->updateTrailPositions();
+    return propagate_(this->nAssigns());
+}
+
+template<typename Base, typename... Ps>
+bool StaticSolver<Base, Ps...>::propagatePropagatorWatches(Lit lit) {
+    this->updateTrailPositions();
+
+    vec<Propagator*>& ws = this->watchers[toInt(lit)];
+    for(int i = 0; i < ws.size(); i++) if(!onWatched_(ws[i], lit)) return false;
+    return true;
+}
+
+template<typename Base, typename... Ps>
+bool StaticSolver<Base, Ps...>::reasonPropagators(Lit lit, Glucose::vec<Lit>& reason_) {
+    assert(this->reason(var(lit)) == CRef_Undef);
+    Propagator* propagator = this->reasonFromPropagator(var(lit));
+    if(propagator == NULL) return false;
+    statistics(int capacity = this->reasonBuffer.capacity() + reason_.capacity();)
+    this->reasonBuffer.clear();
+    getReason_(propagator, lit, this->reasonBuffer);
+    assert(this->reasonBuffer.size() > 0);
+    assert(this->reasonBuffer[0] == lit);
+    this->reasonBuffer.copyTo(reason_);
+    statistics(this->explanations++; if(this->reasonBuffer.capacity() + reason_.capacity() != capacity) this->explanationsAllocations++;)
+    this->cacheReason(this->reasonBuffer);
+    return true;
+}
+
+}
+
+#endif
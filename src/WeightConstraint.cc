@@ -17,7 +17,7 @@
 
 #include "WeightConstraint.h"
 
-#include "GlucoseWrapper.h"
+#include "EmbeddedSolver.h"
 
 namespace zuccherino {
 
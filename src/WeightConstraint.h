@@ -25,6 +25,7 @@ namespace zuccherino {
 struct WeightConstraint {
     friend ostream& operator<<(ostream& out, const WeightConstraint& cc) { return out << cc.toString(); }
     friend class WeightConstraintPropagator;
+    template<typename, typename> friend class AxiomsPropagator;
 public:
     struct VarData : VarDataAxiomsPropagator<WeightConstraint> {};
     struct LitData : LitDataAxiomsPropagator {
@@ -45,8 +46,9 @@ private:
 class WeightConstraintPropagator: public AxiomsPropagator<WeightConstraint, WeightConstraintPropagator> {
     friend AxiomsPropagator;
 public:
-    inline WeightConstraintPropagator(GlucoseWrapper& solver, CardinalityConstraintPropagator* ccPropagator_ = NULL) : AxiomsPropagator(solver, true), ccPropagator(ccPropagator_) {}
-    inline WeightConstraintPropagator(GlucoseWrapper& solver, const WeightConstraintPropagator& init, CardinalityConstraintPropagator* ccPropagator_ = NULL) : AxiomsPropagator(solver, init), ccPropagator(ccPropagator_) {}
+    inline WeightConstraintPropagator(EmbeddedSolver& solver, CardinalityConstraintPropagator* ccPropagator_ = NULL, bool restoreOnCancel = false) : AxiomsPropagator(solver, restoreOnCancel ? CANCEL_RESTORE : CANCEL_NOTIFY), ccPropagator(ccPropagator_) {}
+    inline WeightConstraintPropagator(EmbeddedSolver& solver, const WeightConstraintPropagator& init, CardinalityConstraintPropagator* ccPropagator_ = NULL) : AxiomsPropagator(solver, init), ccPropagator(ccPropagator_) {}
+    using AxiomsPropagator::getReason;
     
     bool addGreaterEqual(vec<Lit>& lits, vec<int64_t>& weights, int64_t bound);
     bool addLessEqual(vec<Lit>& lits, vec<int64_t>& weights, int64_t bound);
@@ -300,6 +300,7 @@ K(s.K)
     s.order_heap.copyTo(order_heap);
     s.preference.memCopyTo(preference);         // zuccherino
     s.preference_heap.copyTo(preference_heap);  // zuccherino
+    s.propagatorWatches.memCopyTo(propagatorWatches);   // zuccherino
     s.clauses.memCopyTo(clauses);
     s.learnts.memCopyTo(learnts);
     s.permanentLearnts.memCopyTo(permanentLearnts);
@@ -371,6 +372,8 @@ bool Solver::isIncremental() {
 Var Solver::newVar(bool sign, bool dvar) {
     int v = nVars();
     preference.push(false);
+    propagatorWatches.push(0);  // zuccherino
+    propagatorWatches.push(0);  // zuccherino
     watches.init(mkLit(v, false));
     watches.init(mkLit(v, true));
     watchesBin.init(mkLit(v, false));
@@ -604,6 +607,7 @@ template <typename T>inline unsigned int Solver::computeLBD(const T &lits, int e
 #endif
     return nblevels;
 }
+template unsigned int Solver::computeLBD(const Clause&, int); // zuccherino: used by GlucoseWrapper
 
 
 
@@ -744,7 +748,7 @@ Lit Solver::pickBranchLit() {
 void Solver::analyze(CRef confl, vec <Lit> &out_learnt, vec <Lit> &selectors, int &out_btlevel, unsigned int &lbd, unsigned int &szWithoutSelectors) {
     int pathC = 0;
     Lit p = lit_Undef;
-    vec<Lit> lits;
+    vec<Lit>& lits = analyze_reason;    // zuccherino
 
     // Generate conflict clause:
     //
@@ -766,6 +770,7 @@ void Solver::analyze(CRef confl, vec <Lit> &out_learnt, vec <Lit> &selectors, in
             if(c.learnt()) {
                 parallelImportClauseDuringConflictAnalysis(c, confl);
                 claBumpActivity(c);
+                if(c.getFromPropagator()) stats[propagatorReasonHits]++;    // zuccherino
             } else { // original clause
                 if(!c.getSeen()) {
                     stats[originalClausesSeen]++;
@@ -969,7 +974,8 @@ void Solver::analyzeFinal(CRef confl, vec <Lit> &out_conflict) {
 
     if(decisionLevel() == 0) return;
 
-    vec<Lit> lits;
+    vec<Lit>& lits = analyze_reason;    // zuccherino
+    lits.clear();
     if(confl == CRef_Undef - 1) { if(conflictPropagators(lits)) {} else { assert(0); } }
     else {
         Clause& clause = ca[confl];
@@ -1139,6 +1145,12 @@ CRef Solver::propagate() {
         }
         ws.shrink(i - j);
 
+        // zuccherino: propagators watching p are invoked next to clause watchers
+        if(confl == CRef_Undef && propagatorWatches[toInt(p)] && !propagatePropagatorWatches(p)) {
+            confl = CRef_Undef - 1;
+            qhead = trail.size();
+        }
+
         // unaryWatches "propagation"
         if(useUnaryWatched && confl == CRef_Undef) {
             confl = propagateUnaryWatches(p);
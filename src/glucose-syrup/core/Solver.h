@@ -87,10 +87,11 @@ enum CoreStats {
   learnts_literals,
   max_literals,
   tot_literals,
-  noDecisionConflict
+  noDecisionConflict,
+  propagatorReasonHits  // zuccherino: reasons of propagators found as clauses by analyze()
 } ;
 
-#define coreStatsSize 24
+#define coreStatsSize 25
 //=================================================================================================
 // Solver -- the main class:
 
@@ -277,8 +278,9 @@ protected:
     bool forceUnsatOnNewDescent;
     // Helper structures:
     //
-    struct VarData { CRef reason; int level; };
-    static inline VarData mkVarData(CRef cr, int l){ VarData d = {cr, l}; return d; }
+    // zuccherino: trailPosition and propagator are maintained by GlucoseWrapper (next to reason and level, as they are read together)
+    struct VarData { CRef reason; int level; int trailPosition; int propagator; };
+    static inline VarData mkVarData(CRef cr, int l){ VarData d = {cr, l, INT_MAX, -1}; return d; }
 
     struct Watcher {
         CRef cref;
@@ -343,6 +345,7 @@ protected:
     Heap<VarOrderLt>    order_heap;       // A priority queue of variables ordered with respect to the variable activity.
     vec<bool>           preference;       // zuccherino: prefer these literals
     Heap<VarOrderLt>    preference_heap;  // zuccherino: order heap for preferred literals
+    vec<char>           propagatorWatches; // zuccherino: literals watched by some propagator, indexed by toInt(lit)
     double              progress_estimate;// Set by 'search()'.
     bool                remove_satisfied; // Indicates whether possibly inefficient linear scan for satisfied clauses should be performed in 'simplify'.
     vec<unsigned int>   permDiff;           // permDiff[var] contains the current conflict number... Used to count the number of  LBD
@@ -369,6 +372,7 @@ protected:
     vec<Lit>            analyze_stack;
     vec<Lit>            analyze_toclear;
     vec<Lit>            add_tmp;
+    vec<Lit>            analyze_reason;   // zuccherino: reasons and conflicts of propagators
     unsigned int  MYFLAG;
 
     // Initial reduceDB strategy
@@ -450,6 +454,7 @@ protected:
     // zuccherino: methods to inject propagators
     virtual inline bool simplifyPropagators() { return true; } // used by simplify(): returns false if a conflict is derived
     virtual inline bool propagatePropagators() { return true; } // used by search(): returns false if a conflict is derived
+    virtual inline bool propagatePropagatorWatches(Lit) { return true; } // used by propagate() for literals in propagatorWatches: returns false if a conflict is derived
     virtual inline bool conflictPropagators(vec<Lit>&) { return false; } // used by analyze(): returns true if the conflict is due to propagators
     virtual inline bool reasonPropagators(Lit, vec<Lit>&) { return false; } // used by analyze(): returns true if the literal was inferred by a propagator
     virtual inline bool reasonPropagators(Lit) { return false; } // used by analyzeFinal(): returns true if the literal was inferred by a propagator
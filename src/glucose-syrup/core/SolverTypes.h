@@ -167,6 +167,7 @@ class Clause {
       unsigned reloced    : 1;
       unsigned exported   : 2; // Values to keep track of the clause status for exportations
       unsigned oneWatched : 1;
+      unsigned fromPropagator : 1;  // zuccherino: reason of a propagator turned into a clause
       unsigned lbd : BITS_LBD;
 
       unsigned size       : BITS_REALSIZE;
@@ -193,6 +194,7 @@ class Clause {
 	header.canbedel = 1;
 	header.exported = 0; 
 	header.oneWatched = 0;
+	header.fromPropagator = 0;
 	header.seen = 0;
         for (int i = 0; i < ps.size(); i++) 
             data[i].lit = ps[i];
@@ -264,6 +266,8 @@ public:
     unsigned int getExported() {return header.exported;}
     void setOneWatched(bool b) {header.oneWatched = b;}
     bool getOneWatched() {return header.oneWatched;}
+    void setFromPropagator(bool b) {header.fromPropagator = b;}
+    bool getFromPropagator() const {return header.fromPropagator;}
 #ifdef INCREMENTAL
     void setSizeWithoutSelectors   (unsigned int n)              {header.szWithoutSelectors = n; }
     unsigned int        sizeWithoutSelectors   () const        { return header.szWithoutSelectors; }
@@ -335,6 +339,7 @@ public:
                 to[cr].setLBD(c.lbd());
                 to[cr].setExported(c.getExported());
                 to[cr].setOneWatched(c.getOneWatched());
+                to[cr].setFromPropagator(c.getFromPropagator());
 #ifdef INCREMENTAL
                 to[cr].setSizeWithoutSelectors(c.sizeWithoutSelectors());
 #endif
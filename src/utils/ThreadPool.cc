@@ -0,0 +1,64 @@
+/*
+ *  Copyright (C) 2017  Mario Alviano (mario@alviano.net)
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#include "ThreadPool.h"
+
+namespace zuccherino {
+
+ThreadPool::ThreadPool(int size) : running(0), stopped(false) {
+    for(int i = 0; i < size; i++) threads.push_back(std::thread([this]() { loop(); }));
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+    }
+    taskAdded.notify_all();
+    for(unsigned i = 0; i < threads.size(); i++) threads[i].join();
+}
+
+void ThreadPool::run(const std::function<void()>& task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(task);
+    }
+    taskAdded.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    taskDone.wait(lock, [this]() { return tasks.empty() && running == 0; });
+}
+
+void ThreadPool::loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for(;;) {
+        taskAdded.wait(lock, [this]() { return stopped || !tasks.empty(); });
+        if(tasks.empty()) return;
+        std::function<void()> task = tasks.back();
+        tasks.pop_back();
+        running++;
+        lock.unlock();
+        task();
+        lock.lock();
+        running--;
+        if(tasks.empty() && running == 0) taskDone.notify_all();
+    }
+}
+
+}
@@ -0,0 +1,55 @@
+/*
+ *  Copyright (C) 2017  Mario Alviano (mario@alviano.net)
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+#ifndef zuccherino_thread_pool_h
+#define zuccherino_thread_pool_h
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace zuccherino {
+
+// fixed number of threads running the tasks passed to run(); wait() blocks until all of them are completed
+class ThreadPool {
+public:
+    explicit ThreadPool(int size);
+    ~ThreadPool();
+
+    inline int size() const { return threads.size(); }
+
+    void run(const std::function<void()>& task);
+    void wait();
+
+private:
+    std::vector<std::thread> threads;
+    std::vector<std::function<void()> > tasks;
+    int running;
+    bool stopped;
+
+    std::mutex mutex;
+    std::condition_variable taskAdded;
+    std::condition_variable taskDone;
+
+    void loop();
+};
+
+}
+
+#endif
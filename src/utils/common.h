@@ -21,6 +21,7 @@
 #include "assert.h"
 #include "math.h"
 #include "print.h"
+#include "stats.h"
 #include "trace.h"
 #include "parse.h"
 #include "vec.h"
@@ -0,0 +1,35 @@
+/*
+ *  Copyright (C) 2017  Mario Alviano (mario@alviano.net)
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+#ifndef zuccherino_stats_h
+#define zuccherino_stats_h
+
+#include <iostream>
+
+namespace zuccherino {
+
+// code collecting and printing statistics is compiled only by the stats build (make BUILD=stats)
+#ifndef STATS_ON
+    #define statistics(code)
+#else
+    #define statistics(code) code
+#endif
+
+#define print_statistics(type, msg) std::cerr << "[" << #type << " stats] " << msg << std::endl;
+
+}
+
+#endif